@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+#include <zx/mat.hpp>
+
+#include "animation_cache.hpp"
+#include "bench.hpp"
+
+// Live heap bytes, counted by the replacements of the global allocation functions below. They apply to the whole bench
+// executable and cost a header and a relaxed atomic add per allocation.
+namespace
+{
+
+std::atomic<std::ptrdiff_t> live_bytes{ 0 };
+constexpr std::size_t header = alignof(std::max_align_t);
+
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size + header);
+    if (!block)
+    {
+        throw std::bad_alloc{};
+    }
+    *static_cast<std::size_t*>(block) = size;
+    live_bytes.fetch_add(static_cast<std::ptrdiff_t>(size), std::memory_order_relaxed);
+    return static_cast<unsigned char*>(block) + header;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        void* block = static_cast<unsigned char*>(ptr) - header;
+        live_bytes.fetch_sub(static_cast<std::ptrdiff_t>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+// Memory per animated entity for 100k entities following the same curve at different phases: each owning its own
+// animation tree, as `PointsModel` points did, against instances of one tree interned in an `anim::cache`.
+BENCH(animation_cache)
+{
+    using namespace anim;
+    using vec2 = zx::mat::vector_t<float, 2>;
+    constexpr std::size_t n = 100000;
+
+    const auto make = []
+    {
+        return ping_pong(gradual(vec2{ 0.F, 250.F }, vec2{ 500.F, 250.F }, duration_t{ 1.F }, ease::sine_in_out), 2.F);
+    };
+
+    const std::ptrdiff_t owned_start = live_bytes.load();
+    std::vector<animation<vec2>> owned;
+    owned.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        owned.push_back(make());
+    }
+    const std::ptrdiff_t owned_bytes = live_bytes.load() - owned_start;
+
+    const std::ptrdiff_t interned_start = live_bytes.load();
+    auto interned = std::make_unique<cache<vec2>>();
+    std::vector<instance<vec2>> instances;
+    instances.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        instances.push_back(interned->instantiate(make(), 0.05F * static_cast<float>(i)));
+    }
+    const std::ptrdiff_t interned_bytes = live_bytes.load() - interned_start;
+
+    bench::row("entities", "storage", "bytes/entity", "shared trees");
+    bench::row(n, "owned trees", static_cast<double>(owned_bytes) / n, n);
+    bench::row(n, "interned", static_cast<double>(interned_bytes) / n, interned->size());
+}
@@ -0,0 +1,68 @@
+#include <vector>
+
+#include "animation.hpp"
+#include "bench.hpp"
+
+// Cost of sampling a gradual animation wrapped in 1 to 16 combinators, and of querying the duration and end value of
+// the outermost one. Each combinator remaps the time once, so sampling should grow linearly with the depth and the
+// queries should not grow at all.
+BENCH(animation_depth)
+{
+    using namespace anim;
+    constexpr std::size_t samples = 100000;
+    constexpr std::size_t queries = 1000000;
+
+    bench::row("depth", "value [ns]", "per level [ns]", "duration [ns]", "end value [ns]");
+    animation<float> anim = gradual(0.F, 1.F, 1.F, ease::quad_in_out);
+    double base = 0.0;
+    for (std::size_t depth = 1; depth <= 16; ++depth)
+    {
+        const duration_t d = anim.duration();
+        switch (depth % 5)
+        {
+            case 0: anim = reverse(anim); break;
+            case 1: anim = repeat(anim, 2.F); break;
+            case 2: anim = ping_pong(anim, 2.F); break;
+            case 3: anim = rescale(anim, d * 0.5F); break;
+            default: anim = slice(anim, 0.1F * d, 0.9F * d); break;
+        }
+
+        const duration_t total = anim.duration();
+        const double value = bench::best_of(
+                                 5,
+                                 [&]
+                                 {
+                                     float sum = 0.F;
+                                     for (std::size_t i = 0; i < samples; ++i)
+                                     {
+                                         sum += anim.value(total * static_cast<float>(i) / samples);
+                                     }
+                                     bench::do_not_optimize(sum);
+                                 })
+                             / samples * 1e9;
+        const auto per_query = [&](auto&& query)
+        {
+            return bench::best_of(
+                       5,
+                       [&]
+                       {
+                           float sum = 0.F;
+                           for (std::size_t i = 0; i < queries; ++i)
+                           {
+                               bench::do_not_optimize(anim);
+                               sum += query();
+                           }
+                           bench::do_not_optimize(sum);
+                       })
+                   / queries * 1e9;
+        };
+        const double duration = per_query([&] { return anim.duration(); });
+        const double end_value = per_query([&] { return anim.end_value(); });
+        if (depth == 1)
+        {
+            base = value;
+        }
+        const double per_level = depth > 1 ? (value - base) / static_cast<double>(depth - 1) : 0.0;
+        bench::row(depth, value, per_level, duration, end_value);
+    }
+}
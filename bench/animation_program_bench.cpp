@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "animation.hpp"
+#include "bench.hpp"
+
+// Evaluation of 100k time points through the virtual animation tree and through its compiled program, one at a time
+// and in batches, with the largest difference of each path from the virtual one.
+BENCH(animation_program)
+{
+    using namespace anim;
+    constexpr std::size_t n = 100000;
+
+    const animation<float> flat = gradual(0.F, 1.F, 1.F, ease::cubic_in_out);
+    const animation<float> nested = repeat(
+        ping_pong(
+            sequence(
+                gradual(0.F, 1.F, 0.5F, ease::quad_in),
+                slice(gradual(1.F, 2.F, 1.F, ease::cubic_out), 0.2F, 0.8F),
+                rescale(reverse(gradual(2.F, 0.F, 1.F, ease::sine_in_out)), 0.7F),
+                constant(0.F, 0.25F)),
+            2.F),
+        4.F);
+
+    std::vector<time_point_t> times(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        // Scattered over the whole animation and slightly beyond it, as the phases of many entities are.
+        times[i] = std::fmod(static_cast<float>(i) * 0.618034F, 20.F) - 1.F;
+    }
+    std::vector<float> reference(n);
+    std::vector<float> out(n);
+
+    bench::row("tree", "path", "time [ns]", "max error");
+    for (const auto& [name, anim] : { std::pair{ "flat", flat }, std::pair{ "nested", nested } })
+    {
+        const program<float> compiled = compile(anim);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            reference[i] = anim.value(times[i]);
+        }
+        const auto measure = [&](const char* path, auto&& run)
+        {
+            const double time = bench::best_of(5, run) / n * 1e9;
+            float error = 0.F;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                error = std::max(error, std::abs(out[i] - reference[i]));
+            }
+            bench::row(name, path, time, error);
+        };
+        measure(
+            "virtual",
+            [&]
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = anim.value(times[i]);
+                }
+                bench::do_not_optimize(out.data());
+            });
+        measure(
+            "virtual batch",
+            [&]
+            {
+                anim.evaluate(times.data(), out.data(), n);
+                bench::do_not_optimize(out.data());
+            });
+        measure(
+            "compiled",
+            [&]
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = compiled.value(times[i]);
+                }
+                bench::do_not_optimize(out.data());
+            });
+        measure(
+            "compiled batch",
+            [&]
+            {
+                compiled.evaluate(times.data(), out.data(), n);
+                bench::do_not_optimize(out.data());
+            });
+    }
+}
+
+// One time point for each of 100k entities animated by trees of their own, as a tick updating a crowd evaluates them.
+BENCH(animation_program_entities)
+{
+    using namespace anim;
+    constexpr std::size_t n = 100000;
+
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> param{ 0.2F, 2.F };
+    std::uniform_int_distribution<int> shape{ 0, 3 };
+    std::vector<animation<float>> anims;
+    anims.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const animation<float> g = gradual(param(rng), param(rng), param(rng), ease::quad_in_out);
+        switch (shape(rng))
+        {
+            case 0: anims.push_back(repeat(g, 4.F)); break;
+            case 1: anims.push_back(ping_pong(reverse(g), 3.F)); break;
+            case 2:
+                anims.push_back(
+                    repeat(sequence(g, slice(gradual(0.F, 1.F, param(rng), ease::cubic_out), 0.1F, 0.9F)), 3.F));
+                break;
+            default: anims.push_back(rescale(ping_pong(g, 2.F), param(rng))); break;
+        }
+    }
+    std::vector<program<float>> programs;
+    programs.reserve(n);
+    for (const animation<float>& anim : anims)
+    {
+        programs.push_back(compile(anim));
+    }
+
+    std::vector<float> out(n);
+    const auto measure = [&](const char* path, const auto& items)
+    {
+        const double time = bench::best_of(
+            5,
+            [&]
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = items[i].value(1.37F + static_cast<float>(i) * 1e-5F);
+                }
+                bench::do_not_optimize(out.data());
+            });
+        bench::row(path, time / n * 1e9);
+    };
+    bench::row("path", "time [ns]");
+    measure("virtual", anims);
+    measure("compiled", programs);
+}
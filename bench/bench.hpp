@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness. Each benchmark registers itself with `BENCH(name)` and prints its own table; the `bench`
+// executable runs the ones whose names contain any of its arguments, or all of them.
+namespace bench
+{
+
+struct entry
+{
+    std::string name;
+    std::function<void()> run;
+};
+
+inline std::vector<entry>& registry()
+{
+    static std::vector<entry> result;
+    return result;
+}
+
+struct registrar
+{
+    registrar(std::string name, std::function<void()> run)
+    {
+        registry().push_back(entry{ std::move(name), std::move(run) });
+    }
+};
+
+// Keeps the compiler from discarding a computed value.
+template <class T>
+void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Best of `repeats` runs of `func`, in seconds. The minimum is the least disturbed by the rest of the system.
+template <class Func>
+double best_of(std::size_t repeats, Func&& func)
+{
+    using clock_t = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < repeats; ++i)
+    {
+        const auto start = clock_t::now();
+        func();
+        best = std::min(best, std::chrono::duration<double>(clock_t::now() - start).count());
+    }
+    return best;
+}
+
+// Prints a row of right-aligned columns.
+template <class... Args>
+void row(const Args&... args)
+{
+    ((std::cout << std::setw(16) << args), ...);
+    std::cout << '\n';
+}
+
+}  // namespace bench
+
+#define BENCH(name)                                                                             \
+    static void bench_##name();                                                                 \
+    static const ::bench::registrar bench_registrar_##name{ #name, &bench_##name };             \
+    static void bench_##name()
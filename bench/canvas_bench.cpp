@@ -0,0 +1,68 @@
+#include <SFML/Graphics.hpp>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "canvas.hpp"
+#include "delaunay.hpp"
+#include "frame_arena.hpp"
+
+// Frame time and draw calls of the outlines of a Voronoi diagram, one shape per face against a single batch.
+// Drawn into an off-screen texture; the frame time covers building the ops, tessellation and submission. Every face
+// lies inside the view, so culling is disabled to draw all of them regardless of the view.
+BENCH(canvas_outlines)
+{
+    using triangulation = delaunay::triangulation_t<float>;
+    constexpr std::size_t frames = 20;
+
+    sf::RenderTexture texture{ { 1024, 768 } };
+    const sf::Font font;
+    const canvas::State state{ canvas::Style{}, canvas::TextStyle{ font }, sf::RenderStates{} };
+    FrameArena arena;
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> x{ 0.F, 1024.F };
+    std::uniform_real_distribution<float> y{ 0.F, 768.F };
+
+    bench::row("faces", "path", "draw calls", "frame [ms]");
+    for (const std::size_t n : { 1000, 20000 })
+    {
+        triangulation t;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            t.insert(triangulation::point_type{ x(rng), y(rng) });
+        }
+        const std::vector<triangulation::polygon_type> faces(t.cells().begin(), t.cells().end());
+        const canvas::StateModifier style = canvas::outline_thickness(1.F)  //
+                                            | canvas::fill_color(sf::Color::Transparent)
+                                            | canvas::outline_color(sf::Color::Red);
+
+        const auto measure = [&](const char* path, auto&& make_op)
+        {
+            canvas::Context::Stats stats;
+            const double frame = bench::best_of(
+                frames,
+                [&]
+                {
+                    texture.clear();
+                    {
+                        const FrameResourceScope scope{ &arena };
+                        canvas::Context ctx{ texture, false };
+                        make_op()(ctx, state);
+                        stats = ctx.stats;
+                    }
+                    texture.display();
+                    arena.reset();
+                });
+            bench::row(faces.size(), path, stats.draw_calls, frame * 1e3);
+        };
+        measure(
+            "per shape",
+            [&]
+            {
+                return canvas::transform(
+                    [&](const triangulation::polygon_type& face) { return canvas::polygon(face) | style; },
+                    faces);
+            });
+        measure("batched", [&] { return canvas::polygons(faces) | style; });
+    }
+}
@@ -0,0 +1,54 @@
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "delaunay.hpp"
+
+// Cost of adding one site to a triangulation of `n` random sites: incrementally, and by triangulating all sites again
+// as `DcelModel` used to do on every added point.
+BENCH(delaunay_insert)
+{
+    using triangulation = delaunay::triangulation_t<float>;
+    constexpr std::size_t inserts = 1000;
+
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> coord{ 0.F, 1000.F };
+    const auto random_points = [&](std::size_t count)
+    {
+        std::vector<triangulation::point_type> result(count);
+        for (triangulation::point_type& p : result)
+        {
+            p = { coord(rng), coord(rng) };
+        }
+        return result;
+    };
+
+    bench::row("sites", "insert [us]", "rebuild [ms]");
+    for (const std::size_t n : { 1000, 10000, 100000, 1000000 })
+    {
+        const std::vector<triangulation::point_type> points = random_points(n);
+        const std::vector<triangulation::point_type> extra = random_points(inserts);
+
+        triangulation t;
+        t.insert(points);
+        const double insert = bench::best_of(
+            1,
+            [&]
+            {
+                for (const triangulation::point_type& p : extra)
+                {
+                    t.insert(p);
+                }
+                bench::do_not_optimize(t.size());
+            });
+        const double rebuild = bench::best_of(
+            1,
+            [&]
+            {
+                triangulation rebuilt;
+                rebuilt.insert(points);
+                bench::do_not_optimize(rebuilt.size());
+            });
+        bench::row(n, insert / inserts * 1e6, rebuild * 1e3);
+    }
+}
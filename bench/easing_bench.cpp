@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "animation.hpp"
+#include "bench.hpp"
+
+// Each easing family in/out evaluated at 100k ratios, one call at a time and through the vectorized batch kernels,
+// with the largest difference of the batch from the scalar result.
+BENCH(easing_batch)
+{
+    using namespace anim::ease::detail;
+    constexpr std::size_t n = 100000;
+
+    std::vector<float> ratios(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        ratios[i] = std::fmod(static_cast<float>(i) * 0.618034F, 1.F);
+    }
+    std::vector<float> scalar(n);
+    std::vector<float> batch(n);
+
+    const std::pair<const char*, type> families[] = {
+        { "quad", type::quad },   { "cubic", type::cubic }, { "quart", type::quart },     { "quint", type::quint },
+        { "sine", type::sine },   { "expo", type::expo },   { "circ", type::circ },       { "back", type::back },
+        { "elastic", type::elastic }, { "bounce", type::bounce },
+    };
+    bench::row("family", "scalar [ns]", "batch [ns]", "speedup", "max error");
+    for (const auto& [name, kind] : families)
+    {
+        const ease_id id{ kind, direction::in_out };
+        const double scalar_time = bench::best_of(
+            5,
+            [&]
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    scalar[i] = evaluate(id, ratios[i]);
+                }
+                bench::do_not_optimize(scalar.data());
+            });
+        const double batch_time = bench::best_of(
+            5,
+            [&]
+            {
+                evaluate(id, ratios.data(), batch.data(), n);
+                bench::do_not_optimize(batch.data());
+            });
+        float error = 0.F;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            error = std::max(error, std::abs(batch[i] - scalar[i]));
+        }
+        bench::row(name, scalar_time / n * 1e9, batch_time / n * 1e9, scalar_time / batch_time, error);
+    }
+}
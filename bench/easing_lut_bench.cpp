@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "animation.hpp"
+#include "bench.hpp"
+
+// The costlier easings evaluated analytically and through lookup tables of several resolutions, at 100k ratios, with
+// the largest error of each table.
+BENCH(easing_lut)
+{
+    namespace ease = anim::ease;
+    constexpr std::size_t n = 100000;
+
+    std::vector<float> ratios(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        ratios[i] = std::fmod(static_cast<float>(i) * 0.618034F, 1.F);
+    }
+    std::vector<float> exact(n);
+    std::vector<float> out(n);
+
+    const auto measure = [&](const auto& ease) -> double
+    {
+        return bench::best_of(
+                   5,
+                   [&]
+                   {
+                       for (std::size_t i = 0; i < n; ++i)
+                       {
+                           out[i] = ease(ratios[i]);
+                       }
+                       bench::do_not_optimize(out.data());
+                   })
+               / n * 1e9;
+    };
+
+    bench::row("easing", "table", "time [ns]", "max error");
+    const auto compare = [&](const char* name, const auto& curve)
+    {
+        bench::row(name, "analytic", measure(curve), 0.F);
+        std::copy(out.begin(), out.end(), exact.begin());
+        for (const std::size_t resolution : { 64, 256, 1024 })
+        {
+            const double time = measure(ease::lut{ curve, resolution });
+            float error = 0.F;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                error = std::max(error, std::abs(out[i] - exact[i]));
+            }
+            bench::row(name, resolution, time, error);
+        }
+    };
+    compare("sine_in_out", ease::sine_in_out);
+    compare("expo_in_out", ease::expo_in_out);
+    compare("circ_in_out", ease::circ_in_out);
+    compare("back_in_out", ease::back_in_out);
+    compare("elastic_in_out", ease::elastic_in_out);
+    compare("bounce_in_out", ease::bounce_in_out);
+}
@@ -0,0 +1,24 @@
+#include <thread>
+
+#include "bench.hpp"
+#include "flock.hpp"
+#include "flock_world.hpp"
+#include "thread_pool.hpp"
+
+// Flock updates per second against the size of the flock, at constant density, on all hardware threads. The demo's
+// fixed step is 10 ms, so a tick must take less than that.
+BENCH(flock_update)
+{
+    constexpr std::size_t ticks = 5;
+    constexpr float step = 0.01F;
+
+    ThreadPool pool{ std::thread::hardware_concurrency() };
+    bench::row("boids", "tick [ms]", "boids/s", "fits 10 ms");
+    for (const std::size_t n : { 1000, 10000, 100000, 200000, 400000 })
+    {
+        Flock flock = make_flock(n);
+        flock.update(step, pool);  // allocates the grid and scratch arrays
+        const double tick = bench::best_of(ticks, [&] { flock.update(step, pool); });
+        bench::row(n, tick * 1e3, static_cast<double>(n) / tick, tick < step ? "yes" : "no");
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cmath>
+#include <random>
+
+#include "flock.hpp"
+
+// Boids at the density of the demo (2000 on 1024 x 768), in a square world sized for `count` of them.
+inline Flock make_flock(std::size_t count)
+{
+    Flock::Settings settings;
+    const float side = std::sqrt(static_cast<float>(count) / 2000.F * 1024.F * 768.F);
+    settings.max = { side, side };
+    Flock flock{ settings };
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> coord{ 0.F, side };
+    std::uniform_real_distribution<float> speed{ -settings.max_speed, settings.max_speed };
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        flock.add(Boid{ Boid::Linear{ { coord(rng), coord(rng) }, { speed(rng), speed(rng) } }, {} });
+    }
+    return flock;
+}
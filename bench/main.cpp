@@ -0,0 +1,25 @@
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "bench.hpp"
+
+int main(int argc, char* argv[])
+{
+    const std::vector<std::string_view> filters(argv + 1, argv + argc);
+    for (const bench::entry& entry : bench::registry())
+    {
+        const bool selected = filters.empty()
+                              || std::any_of(
+                                  filters.begin(),
+                                  filters.end(),
+                                  [&](std::string_view filter) { return entry.name.find(filter) != std::string::npos; });
+        if (selected)
+        {
+            std::cout << "== " << entry.name << '\n';
+            entry.run();
+            std::cout << '\n';
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "model.hpp"
+#include "mpsc_queue.hpp"
+
+namespace
+{
+
+// The queue `App` used before `MpscQueue`, behind a mutex so that it can be shared.
+class LockedQueue
+{
+public:
+    bool try_push(Command&& value)
+    {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        m_items.push_back(std::move(value));
+        return true;
+    }
+
+    std::optional<Command> try_pop()
+    {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (m_items.empty())
+        {
+            return {};
+        }
+        std::optional<Command> result{ std::move(m_items.front()) };
+        m_items.pop_front();
+        return result;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<Command> m_items;
+};
+
+// Seconds for `producers` threads to push `count` commands each while the calling thread pops all of them.
+template <class Queue>
+double transfer(Queue& queue, std::size_t producers, std::size_t count)
+{
+    return bench::best_of(
+        3,
+        [&]
+        {
+            std::vector<std::thread> threads;
+            for (std::size_t p = 0; p < producers; ++p)
+            {
+                threads.emplace_back(
+                    [&queue, count]
+                    {
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            Command command = Commands::AddPoint{ { static_cast<float>(i), 0.F } };
+                            while (!queue.try_push(std::move(command)))
+                            {
+                                std::this_thread::yield();
+                            }
+                        }
+                    });
+            }
+            for (std::size_t received = 0; received < producers * count;)
+            {
+                if (queue.try_pop())
+                {
+                    ++received;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        });
+}
+
+}  // namespace
+
+// Commands per second through `App`'s message queue with 1 to 8 producer threads and one consumer, against a deque
+// behind a mutex.
+BENCH(message_queue)
+{
+    constexpr std::size_t total = 1000000;
+
+    bench::row("producers", "mpsc [M/s]", "mutex [M/s]");
+    for (const std::size_t producers : { 1, 2, 4, 8 })
+    {
+        const std::size_t count = total / producers;
+        MpscQueue<Command> mpsc{ 4096 };
+        LockedQueue locked;
+        const double mpsc_time = transfer(mpsc, producers, count);
+        const double locked_time = transfer(locked, producers, count);
+        const double messages = static_cast<double>(producers * count) * 1e-6;
+        bench::row(producers, messages / mpsc_time, messages / locked_time);
+    }
+}
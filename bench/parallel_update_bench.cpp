@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "animation_store.hpp"
+#include "bench.hpp"
+#include "flock.hpp"
+#include "flock_world.hpp"
+#include "thread_pool.hpp"
+
+// Tick updates of 1M animation tracks and of 100k boids with 1 to N threads, where N is the hardware concurrency but at
+// least 4. Results must be the same for any number of threads.
+BENCH(parallel_update)
+{
+    using vec2 = zx::mat::vector_t<float, 2>;
+    constexpr std::size_t tracks = 1000000;
+    constexpr std::size_t boids = 100000;
+    constexpr std::size_t ticks = 5;
+
+    anim::store<vec2> store;
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> value{ 0.F, 1000.F };
+    std::uniform_real_distribution<float> duration{ 0.5F, 2.F };
+    const anim::ease::detail::ease_id eases[] = {
+        anim::ease::detail::id_of(anim::ease::quad_in_out),
+        anim::ease::detail::id_of(anim::ease::sine_out),
+        anim::ease::detail::id_of(anim::ease::expo_in),
+    };
+    for (std::size_t i = 0; i < tracks; ++i)
+    {
+        store.add({ { value(rng), value(rng) },
+                    { value(rng), value(rng) },
+                    duration(rng),
+                    value(rng) / 1000.F,
+                    eases[i % 3],
+                    static_cast<anim::playback>(i % 3) });
+    }
+    const Flock initial = make_flock(boids);
+    store.update(0.F);  // touches all values before the first measurement
+
+    std::vector<vec2> reference_values;
+    std::vector<vec2> reference_locations;
+    double store_base = 0.0;
+    double flock_base = 0.0;
+    bench::row("threads", "tracks [ms]", "speedup", "boids [ms]", "speedup", "identical");
+    const std::size_t max_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 4);
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        ThreadPool pool{ threads };
+        const double store_time = bench::best_of(
+            ticks,
+            [&]
+            {
+                store.update(1.25F, pool);
+                bench::do_not_optimize(store.values().data());
+            });
+        Flock flock = initial;
+        const double flock_time = bench::best_of(ticks, [&] { flock.update(0.01F, pool); });
+
+        if (threads == 1)
+        {
+            store_base = store_time;
+            flock_base = flock_time;
+            reference_values = store.values();
+            reference_locations = flock.locations();
+        }
+        const bool identical = store.values() == reference_values && flock.locations() == reference_locations;
+        bench::row(
+            threads,
+            store_time * 1e3,
+            store_base / store_time,
+            flock_time * 1e3,
+            flock_base / flock_time,
+            identical ? "yes" : "no");
+    }
+}
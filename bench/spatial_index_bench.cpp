@@ -0,0 +1,99 @@
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "delaunay.hpp"
+#include "spatial_index.hpp"
+
+// Queries over 1M random points: the grid index against a linear scan, and the Voronoi cell containing a point found
+// by walking the triangulation.
+BENCH(spatial_index)
+{
+    using point_type = PointIndex::point_type;
+    constexpr std::size_t n = 1000000;
+    constexpr std::size_t queries = 10000;
+
+    std::mt19937 rng{ 1 };
+    std::uniform_real_distribution<float> coord{ 0.F, 10000.F };
+    std::vector<point_type> points(n);
+    for (point_type& p : points)
+    {
+        p = { coord(rng), coord(rng) };
+    }
+    std::vector<point_type> probes(queries);
+    for (point_type& p : probes)
+    {
+        p = { coord(rng), coord(rng) };
+    }
+
+    PointIndex index;
+    const double build = bench::best_of(
+        1,
+        [&]
+        {
+            for (const point_type& p : points)
+            {
+                index.insert(p);
+            }
+        });
+
+    const auto per_query = [&](auto&& query)
+    {
+        return bench::best_of(
+                   3,
+                   [&]
+                   {
+                       for (const point_type& p : probes)
+                       {
+                           query(p);
+                       }
+                   })
+               / queries * 1e6;
+    };
+    const double nearest = per_query([&](const point_type& p) { bench::do_not_optimize(index.nearest(p)); });
+    const double radius = per_query(
+        [&](const point_type& p)
+        {
+            std::size_t count = 0;
+            index.for_each_in_radius(p, 50.F, [&](std::size_t) { ++count; });
+            bench::do_not_optimize(count);
+        });
+    const double rect = per_query(
+        [&](const point_type& p)
+        {
+            std::size_t count = 0;
+            index.for_each_in_rect(p, point_type{ p[0] + 100.F, p[1] + 100.F }, [&](std::size_t) { ++count; });
+            bench::do_not_optimize(count);
+        });
+    const double scan = bench::best_of(
+                            1,
+                            [&]
+                            {
+                                for (std::size_t q = 0; q < 100; ++q)
+                                {
+                                    const point_type& p = probes[q];
+                                    float best = std::numeric_limits<float>::max();
+                                    for (const point_type& candidate : points)
+                                    {
+                                        const float dx = candidate[0] - p[0];
+                                        const float dy = candidate[1] - p[1];
+                                        best = std::min(best, dx * dx + dy * dy);
+                                    }
+                                    bench::do_not_optimize(best);
+                                }
+                            })
+                        / 100 * 1e6;
+
+    delaunay::triangulation_t<float> triangulation;
+    triangulation.insert(points);
+    const double cell = per_query([&](const point_type& p) { bench::do_not_optimize(triangulation.nearest_site(p)); });
+
+    bench::row("query", "time [us]");
+    bench::row("insert", build / n * 1e6);
+    bench::row("nearest", nearest);
+    bench::row("linear scan", scan);
+    bench::row("radius 50", radius);
+    bench::row("rect 100x100", rect);
+    bench::row("voronoi cell", cell);
+}
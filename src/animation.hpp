@@ -2,7 +2,16 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace anim
 {
@@ -22,706 +31,1758 @@ inline float lerp(float ratio, float a, float b)
     return ((1.F - ratio) * a) + (ratio * b);
 }
 
-template <class T>
-struct animation
+// Interpolation of animated values other than `float`. Specialize for types that cannot be interpolated
+// as `a * (1 - ratio) + b * ratio`.
+template <class T, class = void>
+struct lerp_traits
 {
-    struct impl_type
+    static T lerp(float ratio, const T& a, const T& b)
     {
-        virtual ~impl_type() = default;
+        return a * (1.F - ratio) + b * ratio;
+    }
+};
 
-        virtual duration_t duration() const = 0;
-        virtual T value(time_point_t t) const = 0;
-        virtual T start_value() const = 0;
-        virtual T end_value() const = 0;
-    };
+// The easing is evaluated once and `ratio` shared by all components of `a` and `b`.
+template <class T>
+T lerp(float ratio, const T& a, const T& b)
+{
+    return lerp_traits<T>::lerp(ratio, a, b);
+}
 
-    std::shared_ptr<impl_type> m_impl;
+namespace ease
+{
 
-    explicit animation(std::shared_ptr<impl_type> impl) : m_impl(std::move(impl))
+namespace detail
+{
+
+const inline float pi = std::asin(1.0F) * 2.F;
+const inline float half_pi = pi / 2.F;
+
+constexpr inline float back_overshoot = 1.70158F;
+constexpr inline float bounce_scale = 7.5625F;
+constexpr inline float bounce_width = 2.75F;
+
+enum class type : std::uint8_t
+{
+    linear,
+    quad,
+    cubic,
+    quart,
+    quint,
+    sine,
+    expo,
+    circ,
+    back,
+    elastic,
+    bounce,
+};
+
+enum class direction : std::uint8_t
+{
+    none,
+    in,
+    out,
+    in_out,
+    out_in,
+};
+
+// Identifies a built-in easing at runtime, so that it can be evaluated without a `std::function`.
+struct ease_id
+{
+    type kind = type::linear;
+    direction dir = direction::none;
+};
+
+template <type Type, direction C>
+struct ease_fn_t;
+
+template <type Type, direction C>
+constexpr ease_id id_of(const ease_fn_t<Type, C>&)
+{
+    return ease_id{ Type, C };
+}
+
+template <type Type>
+struct ease_fn_t<Type, direction::in_out>
+{
+    float operator()(float t) const
     {
+        static const ease_fn_t<Type, direction::in> in;
+        static const ease_fn_t<Type, direction::out> out;
+
+        return t < 0.5F  //
+                   ? 0.5F * in(2.F * t)
+                   : 0.5F * out(2.F * t - 1.F) + 0.5F;
     }
+};
 
-    duration_t duration() const
+template <type Type>
+struct ease_fn_t<Type, direction::out_in>
+{
+    float operator()(float t) const
     {
-        return m_impl->duration();
+        static const ease_fn_t<Type, direction::out> out;
+        static const ease_fn_t<Type, direction::in> in;
+
+        return t < 0.5F  //
+                   ? 0.5F * out(2.F * t)
+                   : 0.5F * in(2.F * t - 1.F) + 0.5F;
     }
+};
 
-    T value(time_point_t t) const
+template <direction C>
+struct ease_fn_t<type::linear, C>
+{
+    float operator()(float t) const
     {
-        return m_impl->value(t);
+        return t;
     }
+};
 
-    T operator()(time_point_t t) const
+template <>
+struct ease_fn_t<type::quad, direction::in>
+{
+    float operator()(float t) const
     {
-        return value(t);
+        return std::pow(t, 2);
     }
+};
 
-    T start_value() const
+template <>
+struct ease_fn_t<type::quad, direction::out>
+{
+    float operator()(float t) const
     {
-        return m_impl->start_value();
+        return -t * (t - 2.F);
     }
+};
 
-    T end_value() const
+template <>
+struct ease_fn_t<type::cubic, direction::in>
+{
+    float operator()(float t) const
     {
-        return m_impl->end_value();
+        return std::pow(t, 3);
     }
+};
 
-    T wrapped_value(time_point_t t, time_point_t inflection_point = {}) const
+template <>
+struct ease_fn_t<type::cubic, direction::out>
+{
+    float operator()(float t) const
     {
-        return value(wrap(t, duration(), inflection_point));
+        return std::pow(t - 1.F, 3) + 1.F;
     }
 };
 
-template <class T, class Type, class... Args>
-static animation<T> create(Args&&... args)
+template <>
+struct ease_fn_t<type::quart, direction::in>
 {
-    return animation<T>{ std::make_shared<Type>(std::forward<Args>(args)...) };
-}
+    float operator()(float t) const
+    {
+        return std::pow(t, 4);
+    }
+};
 
-namespace detail
+template <>
+struct ease_fn_t<type::quart, direction::out>
 {
+    float operator()(float t) const
+    {
+        return -(std::pow(t - 1.F, 4) - 1.F);
+    }
+};
 
-struct reverse_fn
+template <>
+struct ease_fn_t<type::quint, direction::in>
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
+    float operator()(float t) const
     {
-    public:
-        explicit impl_type(animation<T> inner) : m_inner(std::move(inner))
-        {
-        }
-
-        duration_t duration() const override
-        {
-            return m_inner.duration();
-        }
-
-        T value(time_point_t t) const override
-        {
-            return m_inner.value(duration() - t);
-        }
-
-        T start_value() const override
-        {
-            return m_inner.end_value();
-        }
-
-        T end_value() const override
-        {
-            return m_inner.start_value();
-        }
-
-    private:
-        animation<T> m_inner;
-    };
+        return std::pow(t, 5);
+    }
+};
 
-    template <class T>
-    auto operator()(animation<T> inner) const -> animation<T>
+template <>
+struct ease_fn_t<type::quint, direction::out>
+{
+    float operator()(float t) const
     {
-        return create<T, impl_type<T>>(std::move(inner));
+        return std::pow(t - 1.F, 5) + 1.F;
     }
 };
 
-struct repeat_fn
+template <>
+struct ease_fn_t<type::sine, direction::in>
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
+    float operator()(float t) const
     {
-    public:
-        explicit impl_type(animation<T> inner, float count, time_point_t inflection_point)
-            : m_inner(std::move(inner))
-            , m_count(count)
-            , m_inflection_point(inflection_point)
-        {
-        }
-
-        duration_t duration() const override
-        {
-            return m_inner.duration() * m_count;
-        }
-
-        T value(time_point_t t) const override
-        {
-            return m_inner.wrapped_value(t, m_inflection_point);
-        }
-
-        T start_value() const override
-        {
-            return m_inner.start_value();
-        }
+        return -std::cos(t * half_pi) + 1.F;
+    }
+};
 
-        T end_value() const override
-        {
-            return m_inner.wrapped_value(this->duration());
-        }
+template <>
+struct ease_fn_t<type::sine, direction::out>
+{
+    float operator()(float t) const
+    {
+        return std::sin(t * half_pi);
+    }
+};
 
-    private:
-        animation<T> m_inner;
-        float m_count;
-        time_point_t m_inflection_point;
-    };
+template <>
+struct ease_fn_t<type::expo, direction::in>
+{
+    float operator()(float t) const
+    {
+        return t == 0.F ? 0.0F : std::pow(2.0F, 10 * (t - 1.F));
+    }
+};
 
-    template <class T>
-    auto operator()(animation<T> inner, float count, time_point_t inflection_point = {}) const -> animation<T>
+template <>
+struct ease_fn_t<type::expo, direction::out>
+{
+    float operator()(float t) const
     {
-        return create<T, impl_type<T>>(std::move(inner), count, inflection_point);
+        return t == 1.F ? 1.F : -std::pow(2.0F, -10 * t) + 1.F;
     }
 };
 
-struct ping_pong_fn
+template <>
+struct ease_fn_t<type::circ, direction::in>
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
+    float operator()(float t) const
     {
-    public:
-        explicit impl_type(animation<T> inner, float count, time_point_t inflection_point)
-            : m_inner(std::move(inner))
-            , m_count(count)
-            , m_inflection_point(inflection_point)
-        {
-        }
+        return -(std::sqrt(1.F - std::pow(t, 2)) - 1.F);
+    }
+};
 
-        duration_t duration() const override
-        {
-            return m_inner.duration() * m_count;
-        }
-
-        T value(time_point_t t) const override
-        {
-            const time_point_t t_ = std::fmod(t, m_inner.duration());
-            return (static_cast<int>(t / m_inner.duration()) % 2 == 0) ? m_inner.value(t_)
-                                                                       : m_inner.value(m_inner.duration() - t_);
-        }
-
-        T start_value() const override
-        {
-            return m_inner.start_value();
-        }
-
-        T end_value() const override
-        {
-            return value(duration());
-        }
-
-    private:
-        animation<T> m_inner;
-        float m_count;
-        time_point_t m_inflection_point;
-    };
+template <>
+struct ease_fn_t<type::circ, direction::out>
+{
+    float operator()(float t) const
+    {
+        return std::sqrt(1.F - std::pow(t - 1, 2));
+    }
+};
 
-    template <class T>
-    auto operator()(animation<T> inner, float count, time_point_t inflection_point = {}) const -> animation<T>
+template <>
+struct ease_fn_t<type::back, direction::in>
+{
+    float operator()(float t) const
     {
-        return create<T, impl_type<T>>(std::move(inner), count, inflection_point);
+        return t * t * ((back_overshoot + 1.F) * t - back_overshoot);
     }
 };
 
-struct slice_fn
+template <>
+struct ease_fn_t<type::back, direction::out>
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
+    float operator()(float t) const
     {
-    public:
-        explicit impl_type(animation<T> inner, time_point_t start, time_point_t end)
-            : m_inner(std::move(inner))
-            , m_start(start)
-            , m_end(end)
-        {
-        }
+        return std::pow(t - 1.F, 2) * ((back_overshoot + 1.F) * (t - 1.F) + back_overshoot) + 1.F;
+    }
+};
 
-        duration_t duration() const override
-        {
-            return m_end - m_start;
-        }
+template <>
+struct ease_fn_t<type::elastic, direction::in>
+{
+    float operator()(float t) const
+    {
+        return t == 0.F || t == 1.F ? t : -std::pow(2.0F, 10 * t - 10) * std::sin((10 * t - 10.75F) * 2.F * pi / 3.F);
+    }
+};
 
-        T value(time_point_t t) const override
-        {
-            return m_inner.value(clamp(t));
-        }
+template <>
+struct ease_fn_t<type::elastic, direction::out>
+{
+    float operator()(float t) const
+    {
+        return t == 0.F || t == 1.F ? t : std::pow(2.0F, -10 * t) * std::sin((10 * t - 0.75F) * 2.F * pi / 3.F) + 1.F;
+    }
+};
 
-        T start_value() const override
+template <>
+struct ease_fn_t<type::bounce, direction::out>
+{
+    float operator()(float t) const
+    {
+        if (t < 1.F / bounce_width)
         {
-            return value(0.F);
+            return bounce_scale * t * t;
         }
-
-        T end_value() const override
+        else if (t < 2.F / bounce_width)
         {
-            return value(duration());
+            t -= 1.5F / bounce_width;
+            return bounce_scale * t * t + 0.75F;
         }
-
-    private:
-        time_point_t clamp(time_point_t t) const
+        else if (t < 2.5F / bounce_width)
         {
-            return std::min(std::min(m_start + t, m_inner.duration()), m_end);
+            t -= 2.25F / bounce_width;
+            return bounce_scale * t * t + 0.9375F;
         }
+        t -= 2.625F / bounce_width;
+        return bounce_scale * t * t + 0.984375F;
+    }
+};
 
-        animation<T> m_inner;
-        time_point_t m_start;
-        time_point_t m_end;
-    };
-
-    template <class T>
-    auto operator()(animation<T> inner, time_point_t start, time_point_t end) const -> animation<T>
+template <>
+struct ease_fn_t<type::bounce, direction::in>
+{
+    float operator()(float t) const
     {
-        return create<T, impl_type<T>>(std::move(inner), start, end);
+        return 1.F - ease_fn_t<type::bounce, direction::out>{}(1.F - t);
     }
 };
 
-struct rescale_fn
+template <type Type>
+float evaluate(direction dir, float t)
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
+    switch (dir)
     {
-    public:
-        explicit impl_type(animation<T> inner, duration_t duration) : m_inner(std::move(inner)), m_duration(duration)
-        {
-        }
+        case direction::in: return ease_fn_t<Type, direction::in>{}(t);
+        case direction::out: return ease_fn_t<Type, direction::out>{}(t);
+        case direction::in_out: return ease_fn_t<Type, direction::in_out>{}(t);
+        case direction::out_in: return ease_fn_t<Type, direction::out_in>{}(t);
+        default: return t;
+    }
+}
 
-        duration_t duration() const override
-        {
-            return m_duration;
-        }
+inline float evaluate(ease_id id, float t)
+{
+    switch (id.kind)
+    {
+        case type::quad: return evaluate<type::quad>(id.dir, t);
+        case type::cubic: return evaluate<type::cubic>(id.dir, t);
+        case type::quart: return evaluate<type::quart>(id.dir, t);
+        case type::quint: return evaluate<type::quint>(id.dir, t);
+        case type::sine: return evaluate<type::sine>(id.dir, t);
+        case type::expo: return evaluate<type::expo>(id.dir, t);
+        case type::circ: return evaluate<type::circ>(id.dir, t);
+        case type::back: return evaluate<type::back>(id.dir, t);
+        case type::elastic: return evaluate<type::elastic>(id.dir, t);
+        case type::bounce: return evaluate<type::bounce>(id.dir, t);
+        default: return t;
+    }
+}
 
-        T value(time_point_t t) const override
-        {
-            return m_inner.value(t * m_inner.duration() / m_duration);
-        }
+// Branch-free forms of the easings for batch evaluation, written so that loops over them are vectorized by the compiler
+// (given -fno-math-errno and -fno-trapping-math). `sine` and `expo` use polynomial approximations instead of libm.
+namespace kernel
+{
 
-        T start_value() const override
-        {
-            return value(0.F);
-        }
+// sin(x * pi / 2), reduced to [-pi / 4, pi / 4] by quadrant
+inline float sin_half_pi(float x)
+{
+    const int k = static_cast<int>(x + (x >= 0.F ? 0.5F : -0.5F));
+    const float a = (x - static_cast<float>(k)) * half_pi;
+    const float z = a * a;
+    const float s = a + a * z * ((-1.9515295891E-4F * z + 8.3321608736E-3F) * z - 1.6666654611E-1F);
+    const float c
+        = 1.F - 0.5F * z + z * z * ((2.443315711809948E-5F * z - 1.388731625493765E-3F) * z + 4.166664568298827E-2F);
+    const float v = (k & 1) != 0 ? c : s;
+    return (k & 2) != 0 ? -v : v;
+}
 
-        T end_value() const override
-        {
-            return value(duration());
-        }
+inline float exp2(float x)
+{
+    x = std::min(std::max(x, -126.F), 127.F);
+    const int n = static_cast<int>(x + (x >= 0.F ? 0.5F : -0.5F));
+    const float f = x - static_cast<float>(n);
+    float p = 1.535336188319500E-4F;
+    p = p * f + 1.339887440266574E-3F;
+    p = p * f + 9.618437357674640E-3F;
+    p = p * f + 5.550332471162809E-2F;
+    p = p * f + 2.402264791363012E-1F;
+    p = p * f + 6.931472028550421E-1F;
+    const std::int32_t bits = (n + 127) << 23;
+    float scale = 0.F;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return (1.F + p * f) * scale;
+}
 
-    private:
-        animation<T> m_inner;
-        duration_t m_duration;
-    };
+inline float quad_in(float t)
+{
+    return t * t;
+}
 
-    template <class T>
-    auto operator()(animation<T> inner, duration_t duration) const -> animation<T>
-    {
-        return create<T, impl_type<T>>(std::move(inner), duration);
-    }
-};
+inline float quad_out(float t)
+{
+    return -t * (t - 2.F);
+}
 
-struct constant_fn
+inline float cubic_in(float t)
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
-    {
-    public:
-        explicit impl_type(T value, duration_t duration) : m_value(value), m_duration(duration)
-        {
-        }
+    return t * t * t;
+}
 
-        duration_t duration() const override
-        {
-            return m_duration;
-        }
+inline float cubic_out(float t)
+{
+    const float u = t - 1.F;
+    return u * u * u + 1.F;
+}
 
-        T value(time_point_t t) const override
-        {
-            return m_value;
-        }
+inline float quart_in(float t)
+{
+    const float t2 = t * t;
+    return t2 * t2;
+}
 
-        T start_value() const override
-        {
-            return m_value;
-        }
+inline float quart_out(float t)
+{
+    const float u2 = (t - 1.F) * (t - 1.F);
+    return 1.F - u2 * u2;
+}
 
-        T end_value() const override
-        {
-            return m_value;
-        }
+inline float quint_in(float t)
+{
+    const float t2 = t * t;
+    return t2 * t2 * t;
+}
 
-    private:
-        T m_value;
-        duration_t m_duration;
-    };
+inline float quint_out(float t)
+{
+    const float u = t - 1.F;
+    const float u2 = u * u;
+    return u2 * u2 * u + 1.F;
+}
 
-    template <class T>
-    auto operator()(T value, duration_t duration) const -> animation<T>
-    {
-        return create<T, impl_type<T>>(value, duration);
-    }
-};
+inline float sine_in(float t)
+{
+    return 1.F - sin_half_pi(t + 1.F);
+}
 
-struct gradual_fn
+inline float sine_out(float t)
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
-    {
-    public:
-        impl_type(duration_t duration, T start_value, T end_value, ease_fn ease)
-            : m_duration(duration)
-            , m_start_value(start_value)
-            , m_end_value(end_value)
-            , m_ease(std::move(ease))
-        {
-        }
+    return sin_half_pi(t);
+}
 
-        duration_t duration() const override
-        {
-            return m_duration;
-        }
+inline float expo_in(float t)
+{
+    const float v = exp2(10.F * (t - 1.F));
+    return t == 0.F ? 0.F : v;
+}
 
-        T value(time_point_t t) const override
-        {
-            return static_cast<T>(lerp(m_ease(t / this->duration()), m_start_value, m_end_value));
-        }
+inline float expo_out(float t)
+{
+    const float v = 1.F - exp2(-10.F * t);
+    return t == 1.F ? 1.F : v;
+}
 
-        T start_value() const override
-        {
-            return m_start_value;
-        }
+inline float circ_in(float t)
+{
+    return 1.F - std::sqrt(1.F - t * t);
+}
 
-        T end_value() const override
-        {
-            return m_end_value;
-        }
+inline float circ_out(float t)
+{
+    const float u = t - 1.F;
+    return std::sqrt(1.F - u * u);
+}
 
-    private:
-        duration_t m_duration;
-        T m_start_value;
-        T m_end_value;
-        ease_fn m_ease;
-    };
+inline float back_in(float t)
+{
+    return t * t * ((back_overshoot + 1.F) * t - back_overshoot);
+}
 
-    template <class T>
-    auto operator()(T start_value, T end_value, duration_t duration, ease_fn ease) const -> animation<T>
-    {
-        return create<T, impl_type<T>>(duration, start_value, end_value, std::move(ease));
-    }
-};
+inline float back_out(float t)
+{
+    const float u = t - 1.F;
+    return u * u * ((back_overshoot + 1.F) * u + back_overshoot) + 1.F;
+}
 
-struct sequence_fn
+// sin((10 * t - c) * 2 * pi / 3) is evaluated as sin_half_pi((10 * t - c) * 4 / 3)
+inline float elastic_in(float t)
 {
-    template <class T>
-    class impl_type : public animation<T>::impl_type
-    {
-    public:
-        explicit impl_type(std::vector<animation<T>> vect) : m_vect(std::move(vect)), m_duration(0.F)
-        {
-            m_duration = std::accumulate(
-                std::begin(m_vect),
-                std::end(m_vect),
-                duration_t{},
-                [](duration_t total, const animation<T>& item) { return total + item.duration(); });
-        }
+    const float v = -exp2(10.F * t - 10.F) * sin_half_pi((10.F * t - 10.75F) * (4.F / 3.F));
+    return t == 0.F || t == 1.F ? t : v;
+}
 
-        duration_t duration() const
-        {
-            return m_duration;
-        }
+inline float elastic_out(float t)
+{
+    const float v = exp2(-10.F * t) * sin_half_pi((10.F * t - 0.75F) * (4.F / 3.F)) + 1.F;
+    return t == 0.F || t == 1.F ? t : v;
+}
 
-        T value(time_point_t t) const override
-        {
-            if (t < 0.F)
+inline float bounce_out(float t)
+{
+    const float u1 = t - 1.5F / bounce_width;
+    const float u2 = t - 2.25F / bounce_width;
+    const float u3 = t - 2.625F / bounce_width;
+    const float v0 = bounce_scale * t * t;
+    const float v1 = bounce_scale * u1 * u1 + 0.75F;
+    const float v2 = bounce_scale * u2 * u2 + 0.9375F;
+    const float v3 = bounce_scale * u3 * u3 + 0.984375F;
+    return t < 1.F / bounce_width ? v0 : t < 2.F / bounce_width ? v1 : t < 2.5F / bounce_width ? v2 : v3;
+}
+
+inline float bounce_in(float t)
+{
+    return 1.F - bounce_out(1.F - t);
+}
+
+}  // namespace kernel
+
+template <float (*In)(float), float (*Out)(float)>
+void evaluate(direction dir, const float* in, float* out, std::size_t count)
+{
+    switch (dir)
+    {
+        case direction::in:
+            for (std::size_t i = 0; i < count; ++i)
             {
-                return start_value();
+                out[i] = In(in[i]);
             }
-            else if (t >= duration())
+            break;
+        case direction::out:
+            for (std::size_t i = 0; i < count; ++i)
             {
-                return end_value();
+                out[i] = Out(in[i]);
             }
+            break;
+        case direction::in_out:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float t = in[i];
+                const float first = 0.5F * In(2.F * t);
+                const float second = 0.5F * Out(2.F * t - 1.F) + 0.5F;
+                out[i] = t < 0.5F ? first : second;
+            }
+            break;
+        case direction::out_in:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float t = in[i];
+                const float first = 0.5F * Out(2.F * t);
+                const float second = 0.5F * In(2.F * t - 1.F) + 0.5F;
+                out[i] = t < 0.5F ? first : second;
+            }
+            break;
+        default:
+            if (in != out)
+            {
+                std::copy(in, in + count, out);
+            }
+            break;
+    }
+}
 
-            for (const auto& anim : m_vect)
+// Evaluates the easing at `count` points; `in` and `out` may be the same array.
+inline void evaluate(ease_id id, const float* in, float* out, std::size_t count)
+{
+    switch (id.kind)
+    {
+        case type::quad: return evaluate<kernel::quad_in, kernel::quad_out>(id.dir, in, out, count);
+        case type::cubic: return evaluate<kernel::cubic_in, kernel::cubic_out>(id.dir, in, out, count);
+        case type::quart: return evaluate<kernel::quart_in, kernel::quart_out>(id.dir, in, out, count);
+        case type::quint: return evaluate<kernel::quint_in, kernel::quint_out>(id.dir, in, out, count);
+        case type::sine: return evaluate<kernel::sine_in, kernel::sine_out>(id.dir, in, out, count);
+        case type::expo: return evaluate<kernel::expo_in, kernel::expo_out>(id.dir, in, out, count);
+        case type::circ: return evaluate<kernel::circ_in, kernel::circ_out>(id.dir, in, out, count);
+        case type::back: return evaluate<kernel::back_in, kernel::back_out>(id.dir, in, out, count);
+        case type::elastic: return evaluate<kernel::elastic_in, kernel::elastic_out>(id.dir, in, out, count);
+        case type::bounce: return evaluate<kernel::bounce_in, kernel::bounce_out>(id.dir, in, out, count);
+        default:
+            if (in != out)
             {
-                if (t > anim.duration())
-                {
-                    t -= anim.duration();
-                }
-                else
-                {
-                    return anim.value(t);
-                }
+                std::copy(in, in + count, out);
             }
+            break;
+    }
+}
 
-            return end_value();
-        }
+}  // namespace detail
 
-        T start_value() const override
-        {
-            return m_vect.front().start_value();
-        }
+constexpr inline auto none = detail::ease_fn_t<detail::type::linear, detail::direction::none>{};
 
-        T end_value() const override
+constexpr inline auto quad_in = detail::ease_fn_t<detail::type::quad, detail::direction::in>{};
+constexpr inline auto quad_out = detail::ease_fn_t<detail::type::quad, detail::direction::out>{};
+constexpr inline auto quad_in_out = detail::ease_fn_t<detail::type::quad, detail::direction::in_out>{};
+constexpr inline auto quad_out_in = detail::ease_fn_t<detail::type::quad, detail::direction::out_in>{};
+
+constexpr inline auto cubic_in = detail::ease_fn_t<detail::type::cubic, detail::direction::in>{};
+constexpr inline auto cubic_out = detail::ease_fn_t<detail::type::cubic, detail::direction::out>{};
+constexpr inline auto cubic_in_out = detail::ease_fn_t<detail::type::cubic, detail::direction::in_out>{};
+constexpr inline auto cubic_out_in = detail::ease_fn_t<detail::type::cubic, detail::direction::out_in>{};
+
+constexpr inline auto quart_in = detail::ease_fn_t<detail::type::quart, detail::direction::in>{};
+constexpr inline auto quart_out = detail::ease_fn_t<detail::type::quart, detail::direction::out>{};
+constexpr inline auto quart_in_out = detail::ease_fn_t<detail::type::quart, detail::direction::in_out>{};
+constexpr inline auto quart_out_in = detail::ease_fn_t<detail::type::quart, detail::direction::out_in>{};
+
+constexpr inline auto quint_in = detail::ease_fn_t<detail::type::quint, detail::direction::in>{};
+constexpr inline auto quint_out = detail::ease_fn_t<detail::type::quint, detail::direction::out>{};
+constexpr inline auto quint_in_out = detail::ease_fn_t<detail::type::quint, detail::direction::in_out>{};
+constexpr inline auto quint_out_in = detail::ease_fn_t<detail::type::quint, detail::direction::out_in>{};
+
+constexpr inline auto sine_in = detail::ease_fn_t<detail::type::sine, detail::direction::in>{};
+constexpr inline auto sine_out = detail::ease_fn_t<detail::type::sine, detail::direction::out>{};
+constexpr inline auto sine_in_out = detail::ease_fn_t<detail::type::sine, detail::direction::in_out>{};
+constexpr inline auto sine_out_in = detail::ease_fn_t<detail::type::sine, detail::direction::out_in>{};
+
+constexpr inline auto expo_in = detail::ease_fn_t<detail::type::expo, detail::direction::in>{};
+constexpr inline auto expo_out = detail::ease_fn_t<detail::type::expo, detail::direction::out>{};
+constexpr inline auto expo_in_out = detail::ease_fn_t<detail::type::expo, detail::direction::in_out>{};
+constexpr inline auto expo_out_in = detail::ease_fn_t<detail::type::expo, detail::direction::out_in>{};
+
+constexpr inline auto circ_in = detail::ease_fn_t<detail::type::circ, detail::direction::in>{};
+constexpr inline auto circ_out = detail::ease_fn_t<detail::type::circ, detail::direction::out>{};
+constexpr inline auto circ_in_out = detail::ease_fn_t<detail::type::circ, detail::direction::in_out>{};
+constexpr inline auto circ_out_in = detail::ease_fn_t<detail::type::circ, detail::direction::out_in>{};
+
+constexpr inline auto back_in = detail::ease_fn_t<detail::type::back, detail::direction::in>{};
+constexpr inline auto back_out = detail::ease_fn_t<detail::type::back, detail::direction::out>{};
+constexpr inline auto back_in_out = detail::ease_fn_t<detail::type::back, detail::direction::in_out>{};
+constexpr inline auto back_out_in = detail::ease_fn_t<detail::type::back, detail::direction::out_in>{};
+
+constexpr inline auto elastic_in = detail::ease_fn_t<detail::type::elastic, detail::direction::in>{};
+constexpr inline auto elastic_out = detail::ease_fn_t<detail::type::elastic, detail::direction::out>{};
+constexpr inline auto elastic_in_out = detail::ease_fn_t<detail::type::elastic, detail::direction::in_out>{};
+constexpr inline auto elastic_out_in = detail::ease_fn_t<detail::type::elastic, detail::direction::out_in>{};
+
+constexpr inline auto bounce_in = detail::ease_fn_t<detail::type::bounce, detail::direction::in>{};
+constexpr inline auto bounce_out = detail::ease_fn_t<detail::type::bounce, detail::direction::out>{};
+constexpr inline auto bounce_in_out = detail::ease_fn_t<detail::type::bounce, detail::direction::in_out>{};
+constexpr inline auto bounce_out_in = detail::ease_fn_t<detail::type::bounce, detail::direction::out_in>{};
+
+// Easing sampled at `resolution + 1` evenly spaced points of [0, 1] and linearly interpolated in between, so that an
+// expensive curve costs a table lookup. Times outside of [0, 1] are clamped. Copies share the table.
+class lut
+{
+public:
+    template <class Ease, std::enable_if_t<!std::is_same_v<std::decay_t<Ease>, lut>, int> = 0>
+    explicit lut(Ease&& ease, std::size_t resolution = 256)
+    {
+        auto samples = std::make_shared<std::vector<float>>(std::max(resolution, std::size_t{ 1 }) + 1);
+        for (std::size_t i = 0; i < samples->size(); ++i)
         {
-            return m_vect.back().end_value();
+            (*samples)[i] = ease(static_cast<float>(i) / static_cast<float>(samples->size() - 1));
         }
+        m_samples = std::move(samples);
+    }
 
-    private:
-        std::vector<animation<T>> m_vect;
-        duration_t m_duration;
-    };
-
-    template <class T, class... Tail>
-    auto operator()(animation<T> head, Tail&&... tail) const -> animation<T>
+    std::size_t resolution() const
     {
-        return (*this)(std::vector<animation<T>>{ std::move(head), std::forward<Tail>(tail)... });
+        return m_samples->size() - 1;
     }
 
-    template <class T>
-    auto operator()(std::vector<animation<T>> vect) const -> animation<T>
+    float operator()(float t) const
     {
-        return create<T, impl_type<T>>(std::move(vect));
+        const std::vector<float>& samples = *m_samples;
+        const float x = std::min(std::max(t, 0.F), 1.F) * static_cast<float>(samples.size() - 1);
+        const std::size_t i = std::min(static_cast<std::size_t>(x), samples.size() - 2);
+        return lerp(x - static_cast<float>(i), samples[i], samples[i + 1]);
     }
+
+private:
+    std::shared_ptr<const std::vector<float>> m_samples;
 };
 
-}  // namespace detail
+}  // namespace ease
 
-static constexpr inline auto reverse = detail::reverse_fn{};
-static constexpr inline auto repeat = detail::repeat_fn{};
-static constexpr inline auto ping_pong = detail::ping_pong_fn{};
-static constexpr inline auto constant = detail::constant_fn{};
-static constexpr inline auto gradual = detail::gradual_fn{};
-static constexpr inline auto slice = detail::slice_fn{};
-static constexpr inline auto rescale = detail::rescale_fn{};
-static constexpr inline auto sequence = detail::sequence_fn{};
+template <class T>
+class program;
 
-namespace ease
+template <class T>
+struct animation
 {
+    struct impl_type
+    {
+        virtual ~impl_type() = default;
 
-namespace detail
-{
+        virtual duration_t duration() const = 0;
+        virtual T value(time_point_t t) const = 0;
+        virtual T start_value() const = 0;
+        virtual T end_value() const = 0;
 
-const inline float pi = std::asin(1.0F) * 2.F;
-const inline float half_pi = pi / 2.F;
+        // Appends the flattened form of the animation to `out`.
+        // Returns false if the animation can only be evaluated through `value`.
+        virtual bool compile(program<T>& out) const
+        {
+            return false;
+        }
 
-enum class type
-{
-    linear,
-    quad,
-    cubic,
-    quart,
-    quint,
-    sine,
-    expo,
-    circ,
-    back,
-    elastic,
-    bounce,
-};
+        virtual void evaluate(const time_point_t* times, T* out, std::size_t count) const
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = value(times[i]);
+            }
+        }
 
-enum class direction
-{
-    none,
-    in,
-    out,
-    in_out,
-    out_in,
-};
+        // Evaluation with state kept by a `cursor` between calls.
+        virtual T play(time_point_t t, std::size_t& hint) const
+        {
+            return value(t);
+        }
+    };
 
-template <type Type, direction C>
-struct ease_fn_t;
+    std::shared_ptr<impl_type> m_impl;
 
-template <type Type>
-struct ease_fn_t<Type, direction::in_out>
-{
-    float operator()(float t) const
+    explicit animation(std::shared_ptr<impl_type> impl) : m_impl(std::move(impl))
     {
-        static const ease_fn_t<Type, direction::in> in;
-        static const ease_fn_t<Type, direction::out> out;
-
-        return t < 0.5F  //
-                   ? 0.5F * in(2.F * t)
-                   : 0.5F * out(2.F * t - 1.F) + 0.5F;
     }
-};
 
-template <type Type>
-struct ease_fn_t<Type, direction::out_in>
-{
-    float operator()(float t) const
+    duration_t duration() const
     {
-        static const ease_fn_t<Type, direction::out> out;
-        static const ease_fn_t<Type, direction::in> in;
-
-        return t < 0.5F  //
-                   ? 0.5F * out(2.F * t)
-                   : 0.5F * in(2.F * t - 1.F) + 0.5F;
+        return m_impl->duration();
     }
-};
 
-template <direction C>
-struct ease_fn_t<type::linear, C>
-{
-    float operator()(float t) const
+    T value(time_point_t t) const
     {
-        return t;
+        return m_impl->value(t);
     }
-};
 
-template <>
-struct ease_fn_t<type::quad, direction::in>
-{
-    float operator()(float t) const
+    T operator()(time_point_t t) const
     {
-        return std::pow(t, 2);
+        return value(t);
     }
-};
 
-template <>
-struct ease_fn_t<type::quad, direction::out>
-{
-    float operator()(float t) const
+    T start_value() const
     {
-        return -t * (t - 2.F);
+        return m_impl->start_value();
     }
-};
 
-template <>
-struct ease_fn_t<type::cubic, direction::in>
-{
-    float operator()(float t) const
+    T end_value() const
     {
-        return std::pow(t, 3);
+        return m_impl->end_value();
     }
-};
 
-template <>
-struct ease_fn_t<type::cubic, direction::out>
-{
-    float operator()(float t) const
+    T wrapped_value(time_point_t t, time_point_t inflection_point = {}) const
     {
-        return std::pow(t - 1.F, 3) + 1.F;
+        return value(wrap(t, duration(), inflection_point));
     }
-};
 
-template <>
-struct ease_fn_t<type::quart, direction::in>
-{
-    float operator()(float t) const
+    // Evaluates the animation at `count` time points, using vectorized easings where possible.
+    // Results may differ from `value` within the precision of the vectorized easings.
+    void evaluate(const time_point_t* times, T* out, std::size_t count) const
     {
-        return std::pow(t, 4);
+        m_impl->evaluate(times, out, count);
     }
 };
 
-template <>
-struct ease_fn_t<type::quart, direction::out>
+namespace detail
 {
-    float operator()(float t) const
-    {
-        return -(std::pow(t - 1.F, 4) - 1.F);
-    }
-};
 
-template <>
-struct ease_fn_t<type::quint, direction::in>
+// Time points are processed in chunks of this size, so that scratch buffers can live on the stack.
+constexpr inline std::size_t batch_size = 256;
+
+template <class T, class Remap>
+void evaluate_remapped(const animation<T>& inner, const time_point_t* times, T* out, std::size_t count, Remap remap)
 {
-    float operator()(float t) const
+    time_point_t buffer[batch_size];
+    for (std::size_t offset = 0; offset < count; offset += batch_size)
     {
-        return std::pow(t, 5);
+        const std::size_t n = std::min(batch_size, count - offset);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            buffer[i] = remap(times[offset + i]);
+        }
+        inner.evaluate(buffer, out + offset, n);
     }
-};
+}
 
-template <>
-struct ease_fn_t<type::quint, direction::out>
+}  // namespace detail
+
+// An animation tree flattened into a contiguous list of operations, evaluated by a loop without virtual calls.
+// Every path through the program is a chain of time remapping operations terminated by a curve operation;
+// a sequence jumps to the chain of its active segment.
+template <class T>
+class program
 {
-    float operator()(float t) const
+public:
+    enum class opcode : std::uint8_t
     {
-        return std::pow(t - 1.F, 5) + 1.F;
-    }
-};
+        reverse,    // t = a - t
+        repeat,     // t = wrap(t, a, b)
+        ping_pong,  // t mirrored on every other period of length a
+        slice,      // t = min(a + t, b)
+        rescale,    // t = t * a / b
+        sequence,   // continue with segments[first + i], the first segment ending at or after t
+        constant,   // values[index]
+        gradual,    // lerp(ease(t / a), values[index], values[index + 1])
+        gradual_fn, // same with eases[first] as easing
+        call,       // calls[index].value(t)
+    };
 
-template <>
-struct ease_fn_t<type::sine, direction::in>
-{
-    float operator()(float t) const
+    struct op
     {
-        return -std::cos(t * half_pi) + 1.F;
-    }
-};
+        opcode code = opcode::constant;
+        ease::detail::ease_id ease = {};
+        std::uint32_t index = 0;
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+        float a = 0.F;
+        float b = 0.F;
+    };
 
-template <>
-struct ease_fn_t<type::sine, direction::out>
-{
-    float operator()(float t) const
+    struct segment
     {
-        return std::sin(t * half_pi);
+        time_point_t start;
+        time_point_t end;
+        std::uint32_t pc;
+    };
+
+    explicit program(const animation<T>& anim)
+        : m_duration(anim.duration())
+        , m_start_value(anim.start_value())
+        , m_end_value(anim.end_value())
+    {
+        emit(anim);
     }
-};
 
-template <>
-struct ease_fn_t<type::expo, direction::in>
-{
-    float operator()(float t) const
+    duration_t duration() const
     {
-        return t == 0.F ? 0.0F : std::pow(2.0F, 10 * (t - 1.F));
+        return m_duration;
     }
-};
 
-template <>
-struct ease_fn_t<type::expo, direction::out>
+    T start_value() const
+    {
+        return m_start_value;
+    }
+
+    T end_value() const
+    {
+        return m_end_value;
+    }
+
+    T operator()(time_point_t t) const
+    {
+        return value(t);
+    }
+
+    T value(time_point_t t) const
+    {
+        return value(t, m_ops.data());
+    }
+
+    void evaluate(const time_point_t* times, T* out, std::size_t count) const
+    {
+        time_point_t buffer[detail::batch_size];
+        for (std::size_t offset = 0; offset < count; offset += detail::batch_size)
+        {
+            const std::size_t n = std::min(detail::batch_size, count - offset);
+            std::copy(times + offset, times + offset + n, buffer);
+            evaluate_chunk(buffer, out + offset, n);
+        }
+    }
+
+    const std::vector<op>& ops() const
+    {
+        return m_ops;
+    }
+
+    const std::vector<T>& values() const
+    {
+        return m_values;
+    }
+
+    const std::vector<segment>& segments() const
+    {
+        return m_segments;
+    }
+
+    // Whether the program refers to easings or animations that are only known as callables.
+    bool has_calls() const
+    {
+        return !m_eases.empty() || !m_calls.empty();
+    }
+
+    // Builders used by `impl_type::compile`.
+
+    void emit(const animation<T>& anim)
+    {
+        if (!anim.m_impl->compile(*this))
+        {
+            m_ops.push_back(op{ opcode::call, {}, index(m_calls) });
+            m_calls.push_back(anim);
+        }
+    }
+
+    void remap(opcode code, float a, float b = 0.F)
+    {
+        m_ops.push_back(op{ code, {}, 0, 0, 0, a, b });
+    }
+
+    void constant(const T& value)
+    {
+        m_ops.push_back(op{ opcode::constant, {}, index(m_values) });
+        m_values.push_back(value);
+    }
+
+    void gradual(
+        duration_t duration,
+        const T& start_value,
+        const T& end_value,
+        const std::optional<ease::detail::ease_id>& id,
+        const ease_fn& ease)
+    {
+        if (id)
+        {
+            m_ops.push_back(op{ opcode::gradual, *id, index(m_values), 0, 0, duration });
+        }
+        else
+        {
+            m_ops.push_back(op{ opcode::gradual_fn, {}, index(m_values), index(m_eases), 0, duration });
+            m_eases.push_back(ease);
+        }
+        m_values.push_back(start_value);
+        m_values.push_back(end_value);
+    }
+
+    void sequence(const std::vector<animation<T>>& items, duration_t duration, const T& start_value, const T& end_value)
+    {
+        const std::uint32_t first = index(m_segments);
+        m_ops.push_back(op{ opcode::sequence, {}, index(m_values), first, index(items), duration });
+        m_values.push_back(start_value);
+        m_values.push_back(end_value);
+        m_segments.resize(m_segments.size() + items.size());
+
+        time_point_t start = 0.F;
+        for (std::size_t i = 0; i < items.size(); ++i)
+        {
+            const time_point_t end = start + items[i].duration();
+            m_segments[first + i] = segment{ start, end, index(m_ops) };
+            emit(items[i]);
+            start = end;
+        }
+    }
+
+private:
+    T value(time_point_t t, const op* o) const
+    {
+        while (true)
+        {
+            switch (o->code)
+            {
+                case opcode::sequence:
+                {
+                    if (t < 0.F)
+                    {
+                        return m_values[o->index];
+                    }
+                    else if (t >= o->a)
+                    {
+                        return m_values[o->index + 1];
+                    }
+                    const auto first = m_segments.begin() + o->first;
+                    const auto seg = std::lower_bound(
+                        first, first + o->count, t, [](const segment& s, time_point_t v) { return s.end < v; });
+                    t -= seg->start;
+                    o = m_ops.data() + seg->pc;
+                    continue;
+                }
+                case opcode::constant: return m_values[o->index];
+                case opcode::gradual:
+                    return static_cast<T>(
+                        lerp(ease::detail::evaluate(o->ease, t / o->a), m_values[o->index], m_values[o->index + 1]));
+                case opcode::gradual_fn:
+                    return static_cast<T>(lerp(m_eases[o->first](t / o->a), m_values[o->index], m_values[o->index + 1]));
+                case opcode::call: return m_calls[o->index].value(t);
+                default: t = remap(*o, t); break;
+            }
+            ++o;
+        }
+    }
+
+    // Remaps all time points in `times` (at most `batch_size`) for as long as the program does not branch.
+    void evaluate_chunk(time_point_t* times, T* out, std::size_t count) const
+    {
+        for (const op* o = m_ops.data();; ++o)
+        {
+            switch (o->code)
+            {
+                case opcode::constant: std::fill(out, out + count, m_values[o->index]); return;
+                case opcode::gradual:
+                {
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        times[i] /= o->a;
+                    }
+                    ease::detail::evaluate(o->ease, times, times, count);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        out[i] = static_cast<T>(lerp(times[i], m_values[o->index], m_values[o->index + 1]));
+                    }
+                    return;
+                }
+                case opcode::sequence:
+                case opcode::gradual_fn:
+                case opcode::call:
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        out[i] = value(times[i], o);
+                    }
+                    return;
+                default:
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        times[i] = remap(*o, times[i]);
+                    }
+                    break;
+            }
+        }
+    }
+
+    static time_point_t remap(const op& o, time_point_t t)
+    {
+        switch (o.code)
+        {
+            case opcode::reverse: return o.a - t;
+            case opcode::repeat: return wrap(t, o.a, o.b);
+            case opcode::ping_pong:
+            {
+                const time_point_t t_ = std::fmod(t, o.a);
+                return static_cast<int>(t / o.a) % 2 == 0 ? t_ : o.a - t_;
+            }
+            case opcode::slice: return std::min(o.a + t, o.b);
+            case opcode::rescale: return t * o.a / o.b;
+            default: return t;
+        }
+    }
+
+    template <class Container>
+    static std::uint32_t index(const Container& container)
+    {
+        return static_cast<std::uint32_t>(container.size());
+    }
+
+    duration_t m_duration;
+    T m_start_value;
+    T m_end_value;
+    std::vector<op> m_ops = {};
+    std::vector<T> m_values = {};
+    std::vector<segment> m_segments = {};
+    std::vector<ease_fn> m_eases = {};
+    std::vector<animation<T>> m_calls = {};
+};
+
+enum class interpolation : std::uint8_t
 {
-    float operator()(float t) const
+    linear,
+    hermite,      // cubic Hermite with the given `tangents`
+    catmull_rom,  // cubic Hermite with tangents from the neighbouring keys
+};
+
+// Keyframe track as parallel arrays, one element per key. `times` must not decrease; `eases`, if not empty, holds the
+// easing of the segment starting at each key; `tangents` are required by `interpolation::hermite` only.
+// Before the first and after the last key the track holds the first and last value.
+template <class T>
+struct keyframes
+{
+    std::vector<time_point_t> times = {};
+    std::vector<T> values = {};
+    std::vector<ease::detail::ease_id> eases = {};
+    std::vector<T> tangents = {};
+    interpolation mode = interpolation::linear;
+};
+
+// Plays an animation at time points that usually increase from one call to the next, e.g. once per tick.
+// Keeps the position of the previous call, so that a sequence finds its active segment in O(1) amortized time instead
+// of a binary search.
+template <class T>
+class cursor
+{
+public:
+    explicit cursor(animation<T> anim) : m_anim(std::move(anim))
     {
-        return t == 1.F ? 1.F : -std::pow(2.0F, -10 * t) + 1.F;
     }
+
+    const animation<T>& get() const
+    {
+        return m_anim;
+    }
+
+    T operator()(time_point_t t)
+    {
+        return m_anim.m_impl->play(t, m_hint);
+    }
+
+private:
+    animation<T> m_anim;
+    std::size_t m_hint = 0;
 };
 
-template <>
-struct ease_fn_t<type::circ, direction::in>
+template <class T, class Type, class... Args>
+static animation<T> create(Args&&... args)
 {
-    float operator()(float t) const
+    return animation<T>{ std::make_shared<Type>(std::forward<Args>(args)...) };
+}
+
+namespace detail
+{
+
+// Base of the combinators: their duration and boundary values are computed once, when the node is built, rather than
+// through the inner tree on every call.
+template <class T>
+class cached_impl : public animation<T>::impl_type
+{
+public:
+    duration_t duration() const final
     {
-        return -(std::sqrt(1.F - std::pow(t, 2)) - 1.F);
+        return m_duration;
+    }
+
+    T start_value() const final
+    {
+        return m_start_value;
+    }
+
+    T end_value() const final
+    {
+        return m_end_value;
     }
+
+protected:
+    duration_t m_duration = {};
+    T m_start_value = {};
+    T m_end_value = {};
 };
 
-template <>
-struct ease_fn_t<type::circ, direction::out>
+struct reverse_fn
 {
-    float operator()(float t) const
+    template <class T>
+    class impl_type : public cached_impl<T>
     {
-        return std::sqrt(1.F - std::pow(t - 1, 2));
+    public:
+        explicit impl_type(animation<T> inner) : m_inner(std::move(inner))
+        {
+            this->m_duration = m_inner.duration();
+            this->m_start_value = m_inner.end_value();
+            this->m_end_value = m_inner.start_value();
+        }
+
+        T value(time_point_t t) const override
+        {
+            return m_inner.value(this->m_duration - t);
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.remap(program<T>::opcode::reverse, this->m_duration);
+            out.emit(m_inner);
+            return true;
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            evaluate_remapped(m_inner, times, out, count, [d = this->m_duration](time_point_t t) { return d - t; });
+        }
+
+    private:
+        animation<T> m_inner;
+    };
+
+    template <class T>
+    auto operator()(animation<T> inner) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(inner));
     }
 };
 
-}  // namespace detail
+struct repeat_fn
+{
+    template <class T>
+    class impl_type : public cached_impl<T>
+    {
+    public:
+        explicit impl_type(animation<T> inner, float count, time_point_t inflection_point)
+            : m_inner(std::move(inner))
+            , m_inner_duration(m_inner.duration())
+            , m_count(count)
+            , m_inflection_point(inflection_point)
+        {
+            this->m_duration = m_inner_duration * m_count;
+            this->m_start_value = m_inner.start_value();
+            this->m_end_value = m_inner.value(wrap(this->m_duration, m_inner_duration, {}));
+        }
 
-constexpr inline auto none = detail::ease_fn_t<detail::type::linear, detail::direction::none>{};
+        T value(time_point_t t) const override
+        {
+            return m_inner.value(wrap(t, m_inner_duration, m_inflection_point));
+        }
 
-constexpr inline auto quad_in = detail::ease_fn_t<detail::type::quad, detail::direction::in>{};
-constexpr inline auto quad_out = detail::ease_fn_t<detail::type::quad, detail::direction::out>{};
-constexpr inline auto quad_in_out = detail::ease_fn_t<detail::type::quad, detail::direction::in_out>{};
-constexpr inline auto quad_out_in = detail::ease_fn_t<detail::type::quad, detail::direction::out_in>{};
+        bool compile(program<T>& out) const override
+        {
+            out.remap(program<T>::opcode::repeat, m_inner_duration, m_inflection_point);
+            out.emit(m_inner);
+            return true;
+        }
 
-constexpr inline auto cubic_in = detail::ease_fn_t<detail::type::cubic, detail::direction::in>{};
-constexpr inline auto cubic_out = detail::ease_fn_t<detail::type::cubic, detail::direction::out>{};
-constexpr inline auto cubic_in_out = detail::ease_fn_t<detail::type::cubic, detail::direction::in_out>{};
-constexpr inline auto cubic_out_in = detail::ease_fn_t<detail::type::cubic, detail::direction::out_in>{};
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            evaluate_remapped(
+                m_inner,
+                times,
+                out,
+                count,
+                [d = m_inner_duration, inflection_point = m_inflection_point](time_point_t t)
+                { return wrap(t, d, inflection_point); });
+        }
 
-constexpr inline auto quart_in = detail::ease_fn_t<detail::type::quart, detail::direction::in>{};
-constexpr inline auto quart_out = detail::ease_fn_t<detail::type::quart, detail::direction::out>{};
-constexpr inline auto quart_in_out = detail::ease_fn_t<detail::type::quart, detail::direction::in_out>{};
-constexpr inline auto quart_out_in = detail::ease_fn_t<detail::type::quart, detail::direction::out_in>{};
+    private:
+        animation<T> m_inner;
+        duration_t m_inner_duration;
+        float m_count;
+        time_point_t m_inflection_point;
+    };
 
-constexpr inline auto quint_in = detail::ease_fn_t<detail::type::quint, detail::direction::in>{};
-constexpr inline auto quint_out = detail::ease_fn_t<detail::type::quint, detail::direction::out>{};
-constexpr inline auto quint_in_out = detail::ease_fn_t<detail::type::quint, detail::direction::in_out>{};
-constexpr inline auto quint_out_in = detail::ease_fn_t<detail::type::quint, detail::direction::out_in>{};
+    template <class T>
+    auto operator()(animation<T> inner, float count, time_point_t inflection_point = {}) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(inner), count, inflection_point);
+    }
+};
 
-constexpr inline auto sine_in = detail::ease_fn_t<detail::type::sine, detail::direction::in>{};
-constexpr inline auto sine_out = detail::ease_fn_t<detail::type::sine, detail::direction::out>{};
-constexpr inline auto sine_in_out = detail::ease_fn_t<detail::type::sine, detail::direction::in_out>{};
-constexpr inline auto sine_out_in = detail::ease_fn_t<detail::type::sine, detail::direction::out_in>{};
+struct ping_pong_fn
+{
+    template <class T>
+    class impl_type : public cached_impl<T>
+    {
+    public:
+        explicit impl_type(animation<T> inner, float count, time_point_t inflection_point)
+            : m_inner(std::move(inner))
+            , m_inner_duration(m_inner.duration())
+            , m_count(count)
+            , m_inflection_point(inflection_point)
+        {
+            this->m_duration = m_inner_duration * m_count;
+            this->m_start_value = m_inner.start_value();
+            this->m_end_value = value(this->m_duration);
+        }
 
-constexpr inline auto expo_in = detail::ease_fn_t<detail::type::expo, detail::direction::in>{};
-constexpr inline auto expo_out = detail::ease_fn_t<detail::type::expo, detail::direction::out>{};
-constexpr inline auto expo_in_out = detail::ease_fn_t<detail::type::expo, detail::direction::in_out>{};
-constexpr inline auto expo_out_in = detail::ease_fn_t<detail::type::expo, detail::direction::out_in>{};
+        T value(time_point_t t) const override
+        {
+            const time_point_t t_ = std::fmod(t, m_inner_duration);
+            return (static_cast<int>(t / m_inner_duration) % 2 == 0) ? m_inner.value(t_)
+                                                                     : m_inner.value(m_inner_duration - t_);
+        }
 
-constexpr inline auto circ_in = detail::ease_fn_t<detail::type::circ, detail::direction::in>{};
-constexpr inline auto circ_out = detail::ease_fn_t<detail::type::circ, detail::direction::out>{};
-constexpr inline auto circ_in_out = detail::ease_fn_t<detail::type::circ, detail::direction::in_out>{};
-constexpr inline auto circ_out_in = detail::ease_fn_t<detail::type::circ, detail::direction::out_in>{};
+        bool compile(program<T>& out) const override
+        {
+            out.remap(program<T>::opcode::ping_pong, m_inner_duration);
+            out.emit(m_inner);
+            return true;
+        }
 
-}  // namespace ease
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            evaluate_remapped(
+                m_inner,
+                times,
+                out,
+                count,
+                [d = m_inner_duration](time_point_t t)
+                {
+                    const time_point_t t_ = std::fmod(t, d);
+                    return static_cast<int>(t / d) % 2 == 0 ? t_ : d - t_;
+                });
+        }
+
+    private:
+        animation<T> m_inner;
+        duration_t m_inner_duration;
+        float m_count;
+        time_point_t m_inflection_point;
+    };
+
+    template <class T>
+    auto operator()(animation<T> inner, float count, time_point_t inflection_point = {}) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(inner), count, inflection_point);
+    }
+};
+
+struct slice_fn
+{
+    template <class T>
+    class impl_type : public cached_impl<T>
+    {
+    public:
+        explicit impl_type(animation<T> inner, time_point_t start, time_point_t end)
+            : m_inner(std::move(inner))
+            , m_start(start)
+            , m_end(std::min(m_inner.duration(), end))
+        {
+            this->m_duration = end - start;
+            this->m_start_value = value(0.F);
+            this->m_end_value = value(this->m_duration);
+        }
+
+        T value(time_point_t t) const override
+        {
+            return m_inner.value(std::min(m_start + t, m_end));
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.remap(program<T>::opcode::slice, m_start, m_end);
+            out.emit(m_inner);
+            return true;
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            evaluate_remapped(
+                m_inner,
+                times,
+                out,
+                count,
+                [start = m_start, end = m_end](time_point_t t) { return std::min(start + t, end); });
+        }
+
+    private:
+        animation<T> m_inner;
+        time_point_t m_start;
+        time_point_t m_end;  // clamped to the inner duration
+    };
+
+    template <class T>
+    auto operator()(animation<T> inner, time_point_t start, time_point_t end) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(inner), start, end);
+    }
+};
+
+struct rescale_fn
+{
+    template <class T>
+    class impl_type : public cached_impl<T>
+    {
+    public:
+        explicit impl_type(animation<T> inner, duration_t duration)
+            : m_inner(std::move(inner))
+            , m_inner_duration(m_inner.duration())
+        {
+            this->m_duration = duration;
+            this->m_start_value = value(0.F);
+            this->m_end_value = value(duration);
+        }
+
+        T value(time_point_t t) const override
+        {
+            return m_inner.value(t * m_inner_duration / this->m_duration);
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.remap(program<T>::opcode::rescale, m_inner_duration, this->m_duration);
+            out.emit(m_inner);
+            return true;
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            evaluate_remapped(
+                m_inner,
+                times,
+                out,
+                count,
+                [inner = m_inner_duration, duration = this->m_duration](time_point_t t) { return t * inner / duration; });
+        }
+
+    private:
+        animation<T> m_inner;
+        duration_t m_inner_duration;
+    };
+
+    template <class T>
+    auto operator()(animation<T> inner, duration_t duration) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(inner), duration);
+    }
+};
+
+struct constant_fn
+{
+    template <class T>
+    class impl_type : public animation<T>::impl_type
+    {
+    public:
+        explicit impl_type(T value, duration_t duration) : m_value(value), m_duration(duration)
+        {
+        }
+
+        duration_t duration() const override
+        {
+            return m_duration;
+        }
+
+        T value(time_point_t t) const override
+        {
+            return m_value;
+        }
+
+        T start_value() const override
+        {
+            return m_value;
+        }
+
+        T end_value() const override
+        {
+            return m_value;
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.constant(m_value);
+            return true;
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            std::fill(out, out + count, m_value);
+        }
+
+    private:
+        T m_value;
+        duration_t m_duration;
+    };
+
+    template <class T>
+    auto operator()(T value, duration_t duration) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(value, duration);
+    }
+};
+
+struct gradual_fn
+{
+    template <class T>
+    class impl_type : public animation<T>::impl_type
+    {
+    public:
+        impl_type(
+            duration_t duration,
+            T start_value,
+            T end_value,
+            ease_fn ease,
+            std::optional<ease::detail::ease_id> ease_id = std::nullopt)
+            : m_duration(duration)
+            , m_start_value(start_value)
+            , m_end_value(end_value)
+            , m_ease(std::move(ease))
+            , m_ease_id(ease_id)
+        {
+        }
+
+        duration_t duration() const override
+        {
+            return m_duration;
+        }
+
+        T value(time_point_t t) const override
+        {
+            return static_cast<T>(lerp(m_ease(t / this->duration()), m_start_value, m_end_value));
+        }
+
+        T start_value() const override
+        {
+            return m_start_value;
+        }
+
+        T end_value() const override
+        {
+            return m_end_value;
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.gradual(m_duration, m_start_value, m_end_value, m_ease_id, m_ease);
+            return true;
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            float ratios[batch_size];
+            for (std::size_t offset = 0; offset < count; offset += batch_size)
+            {
+                const std::size_t n = std::min(batch_size, count - offset);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    ratios[i] = times[offset + i] / m_duration;
+                }
+                if (m_ease_id)
+                {
+                    ease::detail::evaluate(*m_ease_id, ratios, ratios, n);
+                }
+                else
+                {
+                    std::transform(ratios, ratios + n, ratios, m_ease);
+                }
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[offset + i] = static_cast<T>(lerp(ratios[i], m_start_value, m_end_value));
+                }
+            }
+        }
+
+    private:
+        duration_t m_duration;
+        T m_start_value;
+        T m_end_value;
+        ease_fn m_ease;
+        std::optional<ease::detail::ease_id> m_ease_id;  // set for built-in easings
+    };
+
+    template <class T>
+    auto operator()(T start_value, T end_value, duration_t duration, ease_fn ease) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(duration, start_value, end_value, std::move(ease));
+    }
+
+    template <class T, ease::detail::type Type, ease::detail::direction Dir>
+    auto operator()(T start_value, T end_value, duration_t duration, ease::detail::ease_fn_t<Type, Dir> ease) const
+        -> animation<T>
+    {
+        return create<T, impl_type<T>>(duration, start_value, end_value, ease, ease::detail::id_of(ease));
+    }
+};
+
+struct sequence_fn
+{
+    template <class T>
+    class impl_type : public cached_impl<T>
+    {
+    public:
+        explicit impl_type(std::vector<animation<T>> vect) : m_vect(std::move(vect))
+        {
+            m_ends.reserve(m_vect.size());
+            for (const animation<T>& item : m_vect)
+            {
+                this->m_duration += item.duration();
+                m_ends.push_back(this->m_duration);
+            }
+            this->m_start_value = m_vect.front().start_value();
+            this->m_end_value = m_vect.back().end_value();
+        }
+
+        T value(time_point_t t) const override
+        {
+            std::size_t segment = m_ends.size();  // no previous call: binary search
+            return play(t, segment);
+        }
+
+        // `segment` is the segment found by the previous call; searching starts there when time has moved forward.
+        T play(time_point_t t, std::size_t& segment) const override
+        {
+            if (t < 0.F)
+            {
+                return this->m_start_value;
+            }
+            else if (t >= this->m_duration)
+            {
+                return this->m_end_value;
+            }
+
+            if (segment >= m_ends.size() || (segment > 0 && t <= m_ends[segment - 1]))
+            {
+                segment = static_cast<std::size_t>(
+                    std::distance(m_ends.begin(), std::lower_bound(m_ends.begin(), m_ends.end(), t)));
+            }
+            else
+            {
+                while (m_ends[segment] < t)
+                {
+                    ++segment;
+                }
+            }
+            return m_vect[segment].value(segment > 0 ? t - m_ends[segment - 1] : t);
+        }
+
+        bool compile(program<T>& out) const override
+        {
+            out.sequence(m_vect, this->m_duration, this->m_start_value, this->m_end_value);
+            return true;
+        }
+
+    private:
+        std::vector<animation<T>> m_vect;
+        std::vector<time_point_t> m_ends;  // end of each segment, from the start of the sequence
+    };
+
+    template <class T, class... Tail>
+    auto operator()(animation<T> head, Tail&&... tail) const -> animation<T>
+    {
+        return (*this)(std::vector<animation<T>>{ std::move(head), std::forward<Tail>(tail)... });
+    }
+
+    template <class T>
+    auto operator()(std::vector<animation<T>> vect) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(vect));
+    }
+};
+
+// Whether `T` can be scaled by a float and added, as cubic interpolation requires.
+template <class T, class = void>
+struct is_vector_space : std::false_type
+{
+};
+
+template <class T>
+struct is_vector_space<T,
+                       std::void_t<decltype(std::declval<T>() * 1.F + std::declval<T>()),
+                                   decltype(std::declval<T>() - std::declval<T>())>> : std::true_type
+{
+};
+
+struct track_fn
+{
+    template <class T>
+    class impl_type : public animation<T>::impl_type
+    {
+    public:
+        explicit impl_type(keyframes<T> keys) : m_keys(std::move(keys))
+        {
+            const std::size_t size = m_keys.times.size();
+            if (size == 0 || m_keys.values.size() != size)
+            {
+                throw std::invalid_argument{ "keyframes: expected one value for each of at least one key" };
+            }
+            if (!m_keys.eases.empty() && m_keys.eases.size() != size)
+            {
+                throw std::invalid_argument{ "keyframes: expected no easing or one for each key" };
+            }
+            if (!std::is_sorted(m_keys.times.begin(), m_keys.times.end()))
+            {
+                throw std::invalid_argument{ "keyframes: times must not decrease" };
+            }
+            if constexpr (!is_vector_space<T>::value)
+            {
+                if (m_keys.mode != interpolation::linear)
+                {
+                    throw std::invalid_argument{ "keyframes: cubic interpolation is not supported for this type" };
+                }
+            }
+            else if (m_keys.mode == interpolation::catmull_rom)
+            {
+                m_keys.tangents.resize(size);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    const std::size_t prev = i > 0 ? i - 1 : i;
+                    const std::size_t next = i + 1 < size ? i + 1 : i;
+                    const time_point_t span = m_keys.times[next] - m_keys.times[prev];
+                    m_keys.tangents[i] = span > 0.F ? (m_keys.values[next] - m_keys.values[prev]) * (1.F / span) : T{};
+                }
+            }
+            else if (m_keys.mode == interpolation::hermite && m_keys.tangents.size() != size)
+            {
+                throw std::invalid_argument{ "keyframes: hermite interpolation expects one tangent for each key" };
+            }
+        }
+
+        duration_t duration() const override
+        {
+            return m_keys.times.back();
+        }
+
+        T value(time_point_t t) const override
+        {
+            std::size_t segment = m_keys.times.size();
+            return play(t, segment);
+        }
+
+        T play(time_point_t t, std::size_t& segment) const override
+        {
+            const std::vector<time_point_t>& times = m_keys.times;
+            if (t <= times.front())
+            {
+                return m_keys.values.front();
+            }
+            else if (t >= times.back())
+            {
+                return m_keys.values.back();
+            }
+
+            // The segment [times[i], times[i + 1]) containing t.
+            if (segment + 1 >= times.size() || t < times[segment])
+            {
+                segment = static_cast<std::size_t>(
+                    std::distance(times.begin(), std::upper_bound(times.begin(), times.end(), t)) - 1);
+            }
+            else
+            {
+                while (times[segment + 1] <= t)
+                {
+                    ++segment;
+                }
+            }
+            return interpolate(segment, t);
+        }
+
+        T start_value() const override
+        {
+            return m_keys.values.front();
+        }
+
+        T end_value() const override
+        {
+            return m_keys.values.back();
+        }
+
+        void evaluate(const time_point_t* times, T* out, std::size_t count) const override
+        {
+            std::size_t segment = m_keys.times.size();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = play(times[i], segment);
+            }
+        }
+
+    private:
+        T interpolate(std::size_t i, time_point_t t) const
+        {
+            const time_point_t span = m_keys.times[i + 1] - m_keys.times[i];
+            float u = (t - m_keys.times[i]) / span;
+            if (!m_keys.eases.empty())
+            {
+                u = ease::detail::evaluate(m_keys.eases[i], u);
+            }
+            const T& a = m_keys.values[i];
+            const T& b = m_keys.values[i + 1];
+            if constexpr (is_vector_space<T>::value)
+            {
+                if (m_keys.mode != interpolation::linear)
+                {
+                    const float u2 = u * u;
+                    const float u3 = u2 * u;
+                    return a * (2.F * u3 - 3.F * u2 + 1.F) + m_keys.tangents[i] * (span * (u3 - 2.F * u2 + u))
+                           + b * (3.F * u2 - 2.F * u3) + m_keys.tangents[i + 1] * (span * (u3 - u2));
+                }
+            }
+            return static_cast<T>(lerp(u, a, b));
+        }
+
+        keyframes<T> m_keys;
+    };
+
+    template <class T>
+    auto operator()(keyframes<T> keys) const -> animation<T>
+    {
+        return create<T, impl_type<T>>(std::move(keys));
+    }
+};
+
+struct compile_fn
+{
+    template <class T>
+    auto operator()(const animation<T>& anim) const -> program<T>
+    {
+        return program<T>{ anim };
+    }
+};
+
+}  // namespace detail
+
+static constexpr inline auto reverse = detail::reverse_fn{};
+static constexpr inline auto repeat = detail::repeat_fn{};
+static constexpr inline auto ping_pong = detail::ping_pong_fn{};
+static constexpr inline auto constant = detail::constant_fn{};
+static constexpr inline auto gradual = detail::gradual_fn{};
+static constexpr inline auto slice = detail::slice_fn{};
+static constexpr inline auto rescale = detail::rescale_fn{};
+static constexpr inline auto sequence = detail::sequence_fn{};
+static constexpr inline auto track = detail::track_fn{};
+static constexpr inline auto compile = detail::compile_fn{};
 
 }  // namespace anim
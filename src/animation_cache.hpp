@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "animation.hpp"
+
+namespace anim
+{
+
+// Per-entity state of an animation shared through a `cache`: the entities differ only by a time offset and a scale.
+template <class T>
+struct instance
+{
+    animation<T> shared;
+    time_point_t phase = 0.F;
+    float amplitude = 1.F;
+
+    T operator()(time_point_t t) const
+    {
+        return static_cast<T>(shared(t + phase) * amplitude);
+    }
+};
+
+// Interns animations, so that structurally identical trees are built once and shared.
+// Two animations are identical when their compiled programs are: the same combinators with the same durations, values
+// (compared bitwise) and named easings. Animations using easings or nodes only known as callables are not interned.
+template <class T>
+class cache
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "values are hashed and compared bitwise");
+
+    struct stats
+    {
+        std::size_t requests = 0;
+        std::size_t unique = 0;
+        std::size_t uncached = 0;  // requests for animations that could not be interned
+        std::size_t bytes = 0;     // held by the compiled programs identifying the unique animations
+    };
+
+    // Returns the animation stored for the structure of `anim`, storing `anim` if there is none yet.
+    animation<T> intern(const animation<T>& anim)
+    {
+        ++m_stats.requests;
+        program<T> key{ anim };
+        if (key.has_calls())
+        {
+            ++m_stats.uncached;
+            return anim;
+        }
+
+        const std::size_t h = hash(key);
+        const auto [first, last] = m_entries.equal_range(h);
+        for (auto it = first; it != last; ++it)
+        {
+            if (equal(it->second.key, key))
+            {
+                return it->second.value;
+            }
+        }
+        ++m_stats.unique;
+        m_stats.bytes += sizeof(entry) + key.ops().capacity() * sizeof(typename program<T>::op)
+                         + key.values().capacity() * sizeof(T)
+                         + key.segments().capacity() * sizeof(typename program<T>::segment);
+        m_entries.emplace(h, entry{ std::move(key), anim });
+        return anim;
+    }
+
+    instance<T> instantiate(const animation<T>& anim, time_point_t phase = 0.F, float amplitude = 1.F)
+    {
+        return instance<T>{ intern(anim), phase, amplitude };
+    }
+
+    std::size_t size() const
+    {
+        return m_entries.size();
+    }
+
+    const stats& statistics() const
+    {
+        return m_stats;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_stats = stats{};
+    }
+
+private:
+    struct entry
+    {
+        program<T> key;
+        animation<T> value;
+    };
+
+    template <class U>
+    static void combine(std::size_t& seed, const U& item)
+    {
+        std::uint8_t bytes[sizeof(U)];
+        std::memcpy(bytes, &item, sizeof(U));
+        for (const std::uint8_t b : bytes)
+        {
+            seed = (seed ^ b) * std::size_t{ 1099511628211ULL };  // FNV-1a
+        }
+    }
+
+    template <class U>
+    static bool same(const U& lhs, const U& rhs)
+    {
+        return std::memcmp(&lhs, &rhs, sizeof(U)) == 0;
+    }
+
+    static std::size_t hash(const program<T>& p)
+    {
+        std::size_t seed = std::size_t{ 14695981039346656037ULL };
+        for (const auto& o : p.ops())
+        {
+            combine(seed, o.code);
+            combine(seed, o.ease.kind);
+            combine(seed, o.ease.dir);
+            combine(seed, o.index);
+            combine(seed, o.first);
+            combine(seed, o.count);
+            combine(seed, o.a);
+            combine(seed, o.b);
+        }
+        for (const T& v : p.values())
+        {
+            combine(seed, v);
+        }
+        for (const auto& s : p.segments())
+        {
+            combine(seed, s.start);
+            combine(seed, s.end);
+            combine(seed, s.pc);
+        }
+        return seed;
+    }
+
+    static bool equal(const program<T>& lhs, const program<T>& rhs)
+    {
+        const auto same_op = [](const auto& x, const auto& y)
+        {
+            return x.code == y.code && x.ease.kind == y.ease.kind && x.ease.dir == y.ease.dir && x.index == y.index
+                   && x.first == y.first && x.count == y.count && same(x.a, y.a) && same(x.b, y.b);
+        };
+        const auto same_segment = [](const auto& x, const auto& y)
+        { return same(x.start, y.start) && same(x.end, y.end) && x.pc == y.pc; };
+        return std::equal(lhs.ops().begin(), lhs.ops().end(), rhs.ops().begin(), rhs.ops().end(), same_op)
+               && std::equal(lhs.values().begin(),
+                             lhs.values().end(),
+                             rhs.values().begin(),
+                             rhs.values().end(),
+                             [](const T& x, const T& y) { return same(x, y); })
+               && std::equal(lhs.segments().begin(),
+                             lhs.segments().end(),
+                             rhs.segments().begin(),
+                             rhs.segments().end(),
+                             same_segment);
+    }
+
+    std::unordered_multimap<std::size_t, entry> m_entries = {};
+    stats m_stats = {};
+};
+
+}  // namespace anim
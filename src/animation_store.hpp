@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "animation.hpp"
+#include "thread_pool.hpp"
+
+namespace anim
+{
+
+enum class playback : std::uint8_t
+{
+    once,       // holds the end value after `duration`
+    repeat,     // restarts every `duration`
+    ping_pong,  // plays forward and backward in turn
+};
+
+// Structure-of-arrays storage for many gradual animations, each described by its start and end value, duration, phase
+// offset, easing and playback mode. Animations sharing easing and playback mode form a group, whose parameters are kept
+// in parallel arrays so that `update` evaluates the whole group in one vectorizable pass.
+template <class T>
+class store
+{
+public:
+    struct track
+    {
+        T start_value;
+        T end_value;
+        duration_t duration;
+        time_point_t phase = 0.F;
+        ease::detail::ease_id ease = {};
+        playback mode = playback::once;
+    };
+
+    // Returns the index of the animation's value in `values()`.
+    std::size_t add(const track& item)
+    {
+        const auto index = static_cast<std::uint32_t>(m_values.size());
+        group& g = find_group(item.ease, item.mode);
+        g.start_values.push_back(item.start_value);
+        g.end_values.push_back(item.end_value);
+        g.durations.push_back(item.duration);
+        g.phases.push_back(item.phase);
+        g.indices.push_back(index);
+        m_values.push_back(item.start_value);
+        return index;
+    }
+
+    std::size_t size() const
+    {
+        return m_values.size();
+    }
+
+    std::size_t group_count() const
+    {
+        return m_groups.size();
+    }
+
+    // Values as of the last `update`, in the order in which the animations were added.
+    const std::vector<T>& values() const
+    {
+        return m_values;
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        return m_values[index];
+    }
+
+    void update(time_point_t time)
+    {
+        for (const group& g : m_groups)
+        {
+            update(g, time, 0, g.indices.size());
+        }
+    }
+
+    // Same as `update(time)`, with the groups split into chunks of `chunk_size` animations distributed over `pool`.
+    void update(time_point_t time, ThreadPool& pool, std::size_t chunk_size = 16384)
+    {
+        m_chunks.clear();
+        for (const group& g : m_groups)
+        {
+            for (std::size_t first = 0; first < g.indices.size(); first += chunk_size)
+            {
+                m_chunks.push_back(chunk{ &g, first, std::min(first + chunk_size, g.indices.size()) });
+            }
+        }
+        pool.parallel_for(
+            m_chunks.size(),
+            1,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    update(*m_chunks[i].g, time, m_chunks[i].first, m_chunks[i].last);
+                }
+            });
+    }
+
+private:
+    struct group
+    {
+        ease::detail::ease_id ease;
+        playback mode;
+        std::vector<T> start_values = {};
+        std::vector<T> end_values = {};
+        std::vector<duration_t> durations = {};
+        std::vector<time_point_t> phases = {};
+        std::vector<std::uint32_t> indices = {};  // into `m_values`
+    };
+
+    group& find_group(ease::detail::ease_id ease, playback mode)
+    {
+        const auto it = std::find_if(
+            m_groups.begin(),
+            m_groups.end(),
+            [&](const group& g) { return g.ease.kind == ease.kind && g.ease.dir == ease.dir && g.mode == mode; });
+        return it != m_groups.end() ? *it : m_groups.emplace_back(group{ ease, mode });
+    }
+
+    // Updates the animations [first, last) of the group.
+    void update(const group& g, time_point_t time, std::size_t first, std::size_t last)
+    {
+        float ratios[detail::batch_size];
+        for (std::size_t offset = first; offset < last; offset += detail::batch_size)
+        {
+            const std::size_t n = std::min(detail::batch_size, last - offset);
+            const duration_t* durations = g.durations.data() + offset;
+            const time_point_t* phases = g.phases.data() + offset;
+            switch (g.mode)
+            {
+                case playback::once:
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        ratios[i] = std::min(std::max(time + phases[i], 0.F), durations[i]) / durations[i];
+                    }
+                    break;
+                case playback::repeat:
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        const time_point_t t = std::max(time + phases[i], 0.F);
+                        ratios[i] = std::fmod(t, durations[i]) / durations[i];
+                    }
+                    break;
+                case playback::ping_pong:
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        // Folded over a double period, so that no period count is needed to tell the direction.
+                        const time_point_t t_ = std::fmod(std::max(time + phases[i], 0.F), 2.F * durations[i]);
+                        ratios[i] = (t_ < durations[i] ? t_ : 2.F * durations[i] - t_) / durations[i];
+                    }
+                    break;
+            }
+            ease::detail::evaluate(g.ease, ratios, ratios, n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                m_values[g.indices[offset + i]]
+                    = static_cast<T>(lerp(ratios[i], g.start_values[offset + i], g.end_values[offset + i]));
+            }
+        }
+    }
+
+    struct chunk
+    {
+        const group* g;
+        std::size_t first;
+        std::size_t last;
+    };
+
+    std::vector<group> m_groups = {};
+    std::vector<T> m_values = {};
+    std::vector<chunk> m_chunks = {};  // scratch for the parallel update
+};
+
+}  // namespace anim
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <zx/mat.hpp>
+
+#include "animation.hpp"
+
+// Interpolation of the vector, color and transform types used by the application, for use as `anim::animation<T>`.
+
+namespace anim
+{
+
+template <class T, auto N>
+struct lerp_traits<zx::mat::vector_t<T, N>>
+{
+    static zx::mat::vector_t<T, N> lerp(float ratio, const zx::mat::vector_t<T, N>& a, const zx::mat::vector_t<T, N>& b)
+    {
+        zx::mat::vector_t<T, N> result = {};
+        for (std::size_t i = 0; i < static_cast<std::size_t>(N); ++i)
+        {
+            result[i] = static_cast<T>(anim::lerp(ratio, a[i], b[i]));
+        }
+        return result;
+    }
+};
+
+// Channels are clamped, since easings such as `back` and `elastic` overshoot.
+template <>
+struct lerp_traits<sf::Color>
+{
+    static sf::Color lerp(float ratio, const sf::Color& a, const sf::Color& b)
+    {
+        const auto channel = [ratio](std::uint8_t x, std::uint8_t y)
+        {
+            const float value = anim::lerp(ratio, static_cast<float>(x), static_cast<float>(y));
+            return static_cast<std::uint8_t>(std::lround(std::min(std::max(value, 0.F), 255.F)));
+        };
+        return sf::Color{ channel(a.r, b.r), channel(a.g, b.g), channel(a.b, b.b), channel(a.a, b.a) };
+    }
+};
+
+// Element-wise, which keeps translations and scales exact; rotations in between are not rigid.
+template <>
+struct lerp_traits<sf::Transform>
+{
+    static sf::Transform lerp(float ratio, const sf::Transform& a, const sf::Transform& b)
+    {
+        const float* m = a.getMatrix();
+        const float* n = b.getMatrix();
+        const auto at = [&](std::size_t i) { return anim::lerp(ratio, m[i], n[i]); };
+        return sf::Transform{ at(0), at(4), at(12), at(1), at(5), at(13), at(3), at(7), at(15) };
+    }
+};
+
+}  // namespace anim
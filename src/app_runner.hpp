@@ -1,12 +1,26 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <typeindex>
 
+#include "frame_arena.hpp"
+#include "mpsc_queue.hpp"
+#include "triple_buffer.hpp"
+
 using fps_t = float;       // 1/s
 using duration_t = float;  // s
 
@@ -19,10 +33,57 @@ struct InitEvent
 {
 };
 
+// `alpha` is the fraction of a tick elapsed since the last one, for blending the last two simulation states.
 template <class Model>
-using RendererFn = std::function<void(sf::RenderWindow&, const Model&, fps_t)>;
+using RendererFn = std::function<void(sf::RenderWindow&, const Model&, fps_t, float alpha)>;
+
+// Frame times of a loop, recorded by the thread running it and readable from any thread.
+class FrameMetrics
+{
+public:
+    void record(duration_t frame_time)
+    {
+        const std::uint64_t count = m_count.load(std::memory_order_relaxed);
+        const duration_t average = m_average.load(std::memory_order_relaxed);
+        m_last.store(frame_time, std::memory_order_relaxed);
+        m_average.store(count == 0 ? frame_time : average + smoothing * (frame_time - average), std::memory_order_relaxed);
+        m_max.store(std::max(m_max.load(std::memory_order_relaxed), frame_time), std::memory_order_relaxed);
+        m_count.store(count + 1, std::memory_order_relaxed);
+    }
+
+    duration_t last() const
+    {
+        return m_last.load(std::memory_order_relaxed);
+    }
 
-template <class Model, class Msg>
+    // Exponential moving average.
+    duration_t average() const
+    {
+        return m_average.load(std::memory_order_relaxed);
+    }
+
+    duration_t max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr duration_t smoothing = 0.05F;
+
+    std::atomic<duration_t> m_last{ 0.F };
+    std::atomic<duration_t> m_average{ 0.F };
+    std::atomic<duration_t> m_max{ 0.F };
+    std::atomic<std::uint64_t> m_count{ 0 };
+};
+
+// `render` draws a `Snapshot` of the model, which `snapshot` copies out of it after the ticks of each frame. By default
+// the snapshot is the model itself; a smaller type holding only what `render` reads keeps that copy cheap.
+template <class Model, class Msg, class Snapshot = Model>
 struct App
 {
     template <class T>
@@ -30,20 +91,31 @@ struct App
     template <class Event>
     using EventHandler = BaseEventHandler<const Event&>;
 
-    using RenderFn = RendererFn<Model>;
+    using RenderFn = RendererFn<Snapshot>;
+    using SnapshotFn = std::function<void(Snapshot&, const Model&)>;  // overwrites the snapshot, reusing its storage
     using UpdateFn = EventHandler<Msg>;
-    using HandleMsgFn = std::function<void(sf::RenderWindow&, const Msg&)>;
+    using HandleMsgFn = std::function<void(App&, const Msg&)>;
 
     using TypeErasedEventHandler = BaseEventHandler<const void*>;
 
     sf::RenderWindow& m_window;
     Model m_model_state;
     RenderFn render = {};
+    SnapshotFn snapshot = copy_model();
     UpdateFn update = {};
     HandleMsgFn on_msg = {};
-    std::deque<Msg> m_msg_queue = {};
+    // Messages from event handlers, `update` and `post`, handled in order of arrival on the thread running `run`.
+    std::unique_ptr<MpscQueue<Msg>> m_msg_queue = std::make_unique<MpscQueue<Msg>>(4096);
+    std::deque<Msg> m_overflow = {};  // messages of the thread running `run` that found the queue full, handled after it
     std::map<std::type_index, TypeErasedEventHandler> m_subscriptions = {};
     duration_t frame_duration = duration_t{ 0.01 };
+    std::size_t max_catch_up_steps = 5;  // ticks per frame at most; time beyond that is dropped instead of caught up
+    std::unique_ptr<FrameArena> frame_arena = std::make_unique<FrameArena>();  // per-frame allocations of `render`
+    bool threaded = false;  // render on a separate thread, from snapshots of the model published after each frame's ticks
+    std::unique_ptr<FrameMetrics> simulation_metrics = std::make_unique<FrameMetrics>();  // input and ticks of a frame
+    std::unique_ptr<FrameMetrics> render_metrics = std::make_unique<FrameMetrics>();      // drawing of a frame
+    bool m_close_requested = false;
+    std::uint64_t m_ticks = 0;
 
     template <class Head, class... Tail>
     void handle_event(const sf::Event& event)
@@ -59,77 +131,295 @@ struct App
         }
     }
 
+    // Input is handled once per frame, then the simulation advances by as many fixed ticks as the elapsed time allows,
+    // up to `max_catch_up_steps`, and the frame is rendered between the last two ticks.
     void run()
     {
-        sf::Clock clock;
-        duration_t time_since_last_update = 0.F;
-
         publish_event(InitEvent{});
+        process_messages();
+        if (threaded)
+        {
+            run_threaded();
+        }
+        else
+        {
+            run_single_threaded();
+        }
+        m_window.close();
+    }
+
+    // Ends `run` after the current frame.
+    void close()
+    {
+        m_close_requested = true;
+    }
 
-        while (m_window.isOpen())
+    static SnapshotFn copy_model()
+    {
+        if constexpr (std::is_assignable_v<Snapshot&, const Model&>)
         {
-            const duration_t elapsed = clock.restart().asSeconds();
-            time_since_last_update += elapsed;
+            return [](Snapshot& snapshot, const Model& model) { snapshot = model; };
+        }
+        else
+        {
+            return {};
+        }
+    }
 
+    void run_single_threaded()
+    {
+        sf::Clock clock;
+        duration_t time_since_last_update = 0.F;
+        [[maybe_unused]] Snapshot frame = {};
+        while (!m_close_requested)
+        {
+            const duration_t elapsed = clock.restart().asSeconds();
             const fps_t fps = 1.0F / elapsed;
+            const float alpha = simulate(elapsed, time_since_last_update);
 
-            while (time_since_last_update > frame_duration)
+            sf::Clock render_clock;
+            m_window.clear();
             {
-                time_since_last_update -= frame_duration;
-
-                while (const std::optional<sf::Event> event = m_window.pollEvent())
+                const FrameResourceScope scope{ frame_arena.get() };
+                if constexpr (std::is_same_v<Snapshot, Model>)
+                {
+                    render(m_window, m_model_state, fps, alpha);
+                }
+                else
                 {
-                    if (event->is<sf::Event::Closed>())
-                    {
-                        m_window.close();
-                    }
-
-                    handle_event<
-                        sf::Event::Resized,
-                        sf::Event::FocusLost,
-                        sf::Event::FocusGained,
-                        sf::Event::TextEntered,
-                        sf::Event::KeyPressed,
-                        sf::Event::KeyReleased,
-                        sf::Event::MouseWheelScrolled,
-                        sf::Event::MouseButtonPressed,
-                        sf::Event::MouseButtonReleased,
-                        sf::Event::MouseMoved,
-                        sf::Event::MouseMovedRaw,
-                        sf::Event::MouseEntered,
-                        sf::Event::MouseLeft,
-                        sf::Event::JoystickButtonPressed,
-                        sf::Event::JoystickButtonReleased,
-                        sf::Event::JoystickMoved,
-                        sf::Event::JoystickConnected,
-                        sf::Event::JoystickDisconnected,
-                        sf::Event::TouchBegan,
-                        sf::Event::TouchMoved,
-                        sf::Event::TouchEnded,
-                        sf::Event::SensorChanged>(*event);
+                    snapshot(frame, m_model_state);
+                    render(m_window, frame, fps, alpha);
                 }
+            }
+            m_window.display();
+            frame_arena->reset();
+            render_metrics->record(render_clock.getElapsedTime().asSeconds());
+        }
+    }
 
-                publish_event(TickEvent{ frame_duration });
+    // The window's events are still polled on this thread, which created it; the render thread only draws to it.
+    void run_threaded()
+    {
+        using clock_t = std::chrono::steady_clock;
+        struct Published
+        {
+            Snapshot snapshot;
+            clock_t::time_point time;  // of the last tick
+        };
+        TripleBuffer<Published> snapshots;
+        std::atomic<bool> stop{ false };
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error = nullptr;
 
-                while (!m_msg_queue.empty())
+        if (!m_window.setActive(false))
+        {
+            throw std::runtime_error{ "Unable to release the window's context for the render thread" };
+        }
+        std::thread renderer(
+            [&]
+            {
+                try
                 {
-                    Msg msg = m_msg_queue.front();
-                    m_msg_queue.pop_front();
-                    if (on_msg)
-                    {
-                        on_msg(m_window, msg);
-                    }
-                    const std::optional<Msg> maybe_msg = update(m_model_state, msg);
-                    if (maybe_msg)
-                    {
-                        m_msg_queue.push_back(*maybe_msg);
-                    }
+                    render_snapshots(snapshots, stop);
                 }
+                catch (...)
+                {
+                    error = std::current_exception();
+                    failed = true;
+                }
+                (void)m_window.setActive(false);
+            });
+        // Written into the back slot, so that the copy reuses the storage of an earlier snapshot.
+        const auto publish_snapshot = [&]
+        {
+            Published& published = snapshots.back();
+            snapshot(published.snapshot, m_model_state);
+            published.time = clock_t::now();
+            snapshots.publish();
+        };
+        const auto join_renderer = [&]
+        {
+            stop = true;
+            renderer.join();
+            (void)m_window.setActive(true);
+        };
+
+        try
+        {
+            sf::Clock clock;
+            duration_t time_since_last_update = 0.F;
+            publish_snapshot();
+            while (!m_close_requested && !failed)
+            {
+                const std::uint64_t ticks = m_ticks;
+                simulate(clock.restart().asSeconds(), time_since_last_update);
+                if (m_ticks != ticks)
+                {
+                    publish_snapshot();
+                }
+                sf::sleep(sf::seconds(frame_duration - time_since_last_update));
             }
+        }
+        catch (...)
+        {
+            join_renderer();
+            throw;
+        }
+        join_renderer();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
 
+    // Render thread of `run_threaded`: draws the latest snapshot until `stop` is set, without waiting for new ones;
+    // frames between two snapshots are blended further along by the time elapsed since the last tick. Frames are paced
+    // by vertical sync, and once a snapshot has been drawn fully blended, the thread idles until the next one.
+    template <class Published>
+    void render_snapshots(TripleBuffer<Published>& snapshots, const std::atomic<bool>& stop)
+    {
+        if (!m_window.setActive(true))
+        {
+            throw std::runtime_error{ "Unable to activate the window's context on the render thread" };
+        }
+        m_window.setVerticalSyncEnabled(true);
+
+        constexpr auto idle = std::chrono::milliseconds{ 1 };
+        sf::Clock clock;
+        std::optional<std::chrono::steady_clock::time_point> finished = {};  // snapshot last drawn with alpha 1
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            const Published* published = snapshots.acquire();
+            if (!published || published->time == finished)
+            {
+                std::this_thread::sleep_for(idle);
+                continue;
+            }
+            const fps_t fps = 1.0F / clock.restart().asSeconds();
+            const duration_t since_tick
+                = std::chrono::duration<duration_t>(std::chrono::steady_clock::now() - published->time).count();
+            const float alpha = std::min(since_tick / frame_duration, 1.F);
+            if (alpha >= 1.F)
+            {
+                finished = published->time;
+            }
+
+            sf::Clock render_clock;
             m_window.clear();
-            render(m_window, m_model_state, fps);
+            {
+                const FrameResourceScope scope{ frame_arena.get() };
+                render(m_window, published->snapshot, fps, alpha);
+            }
             m_window.display();
+            frame_arena->reset();
+            render_metrics->record(render_clock.getElapsedTime().asSeconds());
+        }
+    }
+
+    // Handles the input of a frame and runs the ticks due after `elapsed` more seconds.
+    // Returns the fraction of a tick elapsed since the last one.
+    float simulate(duration_t elapsed, duration_t& time_since_last_update)
+    {
+        sf::Clock simulation_clock;
+        time_since_last_update += elapsed;
+
+        poll_events();
+        process_messages();
+
+        std::size_t steps = 0;
+        while (time_since_last_update >= frame_duration && steps < max_catch_up_steps)
+        {
+            time_since_last_update -= frame_duration;
+            ++steps;
+            ++m_ticks;
+            publish_event(TickEvent{ frame_duration });
+            process_messages();
+        }
+        if (time_since_last_update >= frame_duration)
+        {
+            time_since_last_update = std::fmod(time_since_last_update, frame_duration);
+        }
+        simulation_metrics->record(simulation_clock.getElapsedTime().asSeconds());
+        return time_since_last_update / frame_duration;
+    }
+
+    void poll_events()
+    {
+        while (const std::optional<sf::Event> event = m_window.pollEvent())
+        {
+            if (event->is<sf::Event::Closed>())
+            {
+                close();
+            }
+
+            handle_event<
+                sf::Event::Resized,
+                sf::Event::FocusLost,
+                sf::Event::FocusGained,
+                sf::Event::TextEntered,
+                sf::Event::KeyPressed,
+                sf::Event::KeyReleased,
+                sf::Event::MouseWheelScrolled,
+                sf::Event::MouseButtonPressed,
+                sf::Event::MouseButtonReleased,
+                sf::Event::MouseMoved,
+                sf::Event::MouseMovedRaw,
+                sf::Event::MouseEntered,
+                sf::Event::MouseLeft,
+                sf::Event::JoystickButtonPressed,
+                sf::Event::JoystickButtonReleased,
+                sf::Event::JoystickMoved,
+                sf::Event::JoystickConnected,
+                sf::Event::JoystickDisconnected,
+                sf::Event::TouchBegan,
+                sf::Event::TouchMoved,
+                sf::Event::TouchEnded,
+                sf::Event::SensorChanged>(*event);
+        }
+    }
+
+    void process_messages()
+    {
+        while (true)
+        {
+            std::optional<Msg> msg = m_msg_queue->try_pop();
+            if (!msg && !m_overflow.empty())
+            {
+                msg = std::move(m_overflow.front());
+                m_overflow.pop_front();
+            }
+            if (!msg)
+            {
+                break;
+            }
+            if (on_msg)
+            {
+                on_msg(*this, *msg);
+            }
+            if (std::optional<Msg> maybe_msg = update(m_model_state, *msg))
+            {
+                push_message(std::move(*maybe_msg));
+            }
+        }
+    }
+
+    // Queues a message from any thread, for the next time messages are processed; waits while the queue is full.
+    // The thread running `run` drains the queue, so it must not wait on it: from there, use `push_message`.
+    void post(Msg msg)
+    {
+        while (!m_msg_queue->try_push(std::move(msg)))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Thread running `run` only. Once the queue is full, messages spill over into `m_overflow`, and keep going there
+    // until it has been drained, so that they are still handled in the order they were pushed.
+    void push_message(Msg msg)
+    {
+        if (!m_overflow.empty() || !m_msg_queue->try_push(std::move(msg)))
+        {
+            m_overflow.push_back(std::move(msg));
         }
     }
 
@@ -148,9 +438,9 @@ struct App
         for (auto it = b; it != e; ++it)
         {
             const auto& update_fn = it->second;
-            if (const std::optional<Msg> maybe_msg = update_fn(m_model_state, event); maybe_msg.has_value())
+            if (std::optional<Msg> maybe_msg = update_fn(m_model_state, event); maybe_msg.has_value())
             {
-                m_msg_queue.push_back(*maybe_msg);
+                push_message(std::move(*maybe_msg));
             }
         }
     }
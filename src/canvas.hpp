@@ -3,11 +3,22 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Window.hpp>
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
 #include <zx/mat.hpp>
 
+#include "frame_arena.hpp"
+
 template <class T>
 sf::Vector2<T> convert(const zx::mat::vector_t<T, 2>& v)
 {
@@ -60,38 +71,345 @@ struct State
 
 struct Context
 {
+    struct Stats
+    {
+        std::size_t drawn = 0;
+        std::size_t culled = 0;
+        std::size_t draw_calls = 0;  // calls to the target's `draw`
+    };
+
     sf::RenderTarget& target;
+    bool culling = true;  // skip primitives whose bounds are outside of the target's view
+    Stats stats = {};
+    std::optional<sf::FloatRect> view_bounds = {};  // world rectangle of the view, taken on first use
+
+    template <class... Args>
+    void draw(const Args&... args)
+    {
+        ++stats.draw_calls;
+        target.draw(args...);
+    }
 };
 
-struct DrawOp : public std::function<void(Context&, const State&)>
+inline void apply_style(sf::Shape& shape, const Style& style)
 {
-    using base_t = std::function<void(Context&, const State&)>;
-    using base_t::base_t;
+    shape.setFillColor(style.fill_color);
+    shape.setOutlineColor(style.outline_color);
+    shape.setOutlineThickness(style.outline_thickness);
+}
+
+namespace detail
+{
+
+// Vector of trivially copyable elements which keeps up to `N` of them inline, so that ops made of a primitive and a
+// handful of modifiers need no allocation. Larger contents go to the frame resource.
+template <class T, std::size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const T* begin() const
+    {
+        return m_size <= N ? m_inline.data() : m_heap.data();
+    }
+
+    const T* end() const
+    {
+        return begin() + m_size;
+    }
+
+    T* begin()
+    {
+        return m_size <= N ? m_inline.data() : m_heap.data();
+    }
+
+    T* end()
+    {
+        return begin() + m_size;
+    }
+
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > N)
+        {
+            m_heap.reserve(capacity);
+        }
+    }
+
+    void push_back(const T& item)
+    {
+        const T copy = item;
+        insert(m_size, &copy, 1);
+    }
+
+    // `first` must not point into this vector.
+    void insert(std::size_t pos, const T* first, std::size_t count)
+    {
+        const std::size_t new_size = m_size + count;
+        if (new_size <= N)
+        {
+            std::copy_backward(m_inline.begin() + pos, m_inline.begin() + m_size, m_inline.begin() + new_size);
+            std::copy(first, first + count, m_inline.begin() + pos);
+        }
+        else
+        {
+            if (m_size <= N)
+            {
+                m_heap.assign(m_inline.begin(), m_inline.begin() + m_size);
+            }
+            m_heap.insert(m_heap.begin() + pos, first, first + count);
+        }
+        m_size = new_size;
+    }
+
+    void clear()
+    {
+        m_heap.clear();
+        m_size = 0;
+    }
+
+private:
+    std::size_t m_size = 0;
+    std::array<T, N> m_inline;
+    std::pmr::vector<T> m_heap{ frame_resource() };
+};
+
+template <class... Ts>
+struct overloaded : Ts...
+{
+    using Ts::operator()...;
+};
+
+template <class... Ts>
+overloaded(Ts...) -> overloaded<Ts...>;
+
+// State opcodes.
+struct PushState
+{
+};
+struct PopState
+{
+};
+struct SetFillColor
+{
+    sf::Color value;
+};
+struct SetOutlineColor
+{
+    sf::Color value;
+};
+struct SetOutlineThickness
+{
+    float value;
+};
+struct SetTextStyle
+{
+    std::uint32_t value;
+};
+struct AddTextStyle
+{
+    std::uint32_t value;
+};
+struct SetFont
+{
+    const sf::Font* value;
+};
+struct SetFontSize
+{
+    std::uint32_t value;
+};
+struct SetBlendMode
+{
+    sf::BlendMode value;
+};
+struct Translate
+{
+    sf::Vector2f value;
+};
+struct Scale
+{
+    sf::Vector2f value;
+};
+struct Rotate
+{
+    float value;
+};
+struct ModifyState  // arbitrary `StateModifier` callback
+{
+    std::uint32_t index;
+};
+
+// Primitive opcodes. Variable sized payloads live in the pools of the owning `DrawOp`.
+struct DrawText
+{
+    std::uint32_t index;
+};
+struct DrawRect
+{
+    sf::Vector2f size;
+};
+struct DrawCircle
+{
+    float radius;
+};
+struct DrawTriangle
+{
+    std::array<sf::Vector2f, 3> vertices;
+};
+struct DrawPolygon
+{
+    std::uint32_t offset;
+    std::uint32_t count;
+    sf::FloatRect bounds;
+};
+struct DrawBatch  // `VertexBatch` drawn in a single call
+{
+    std::uint32_t index;
+};
+struct Call  // arbitrary `DrawOp` callback
+{
+    std::uint32_t index;
+};
+
+using Command = std::variant<
+    PushState,
+    PopState,
+    SetFillColor,
+    SetOutlineColor,
+    SetOutlineThickness,
+    SetTextStyle,
+    AddTextStyle,
+    SetFont,
+    SetFontSize,
+    SetBlendMode,
+    Translate,
+    Scale,
+    Rotate,
+    ModifyState,
+    DrawText,
+    DrawRect,
+    DrawCircle,
+    DrawTriangle,
+    DrawPolygon,
+    DrawBatch,
+    Call>;
+
+using Commands = SmallVector<Command, 6>;
+
+inline auto bounds(const sf::Vector2f* points, std::size_t count) -> sf::FloatRect
+{
+    if (count == 0)
+    {
+        return sf::FloatRect{};
+    }
+    sf::Vector2f min = points[0];
+    sf::Vector2f max = points[0];
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        min = sf::Vector2f{ std::min(min.x, points[i].x), std::min(min.y, points[i].y) };
+        max = sf::Vector2f{ std::max(max.x, points[i].x), std::max(max.y, points[i].y) };
+    }
+    return sf::FloatRect{ min, max - min };
+}
+
+inline bool intersects(const sf::FloatRect& lhs, const sf::FloatRect& rhs)
+{
+    return lhs.position.x <= rhs.position.x + rhs.size.x && rhs.position.x <= lhs.position.x + lhs.size.x
+           && lhs.position.y <= rhs.position.y + rhs.size.y && rhs.position.y <= lhs.position.y + lhs.size.y;
+}
+
+// Offsets added to the pool indices of commands moved into another op.
+struct Rebase
+{
+    std::uint32_t points = 0;
+    std::uint32_t texts = 0;
+    std::uint32_t callbacks = 0;
+    std::uint32_t modifiers = 0;
+    std::uint32_t batches = 0;
+
+    void operator()(Command& command) const
+    {
+        std::visit(
+            overloaded{ [&](DrawPolygon& c) { c.offset += points; },
+                        [&](DrawText& c) { c.index += texts; },
+                        [&](Call& c) { c.index += callbacks; },
+                        [&](ModifyState& c) { c.index += modifiers; },
+                        [&](DrawBatch& c) { c.index += batches; },
+                        [](auto&) {} },
+            command);
+    }
 };
 
-struct StateModifier
+}  // namespace detail
+
+// Geometry prepared for drawing many primitives in a single call; see `line_batch` and `points`.
+// Each element of the batch (a point, a polygon outline, ...) is culled on its own.
+class VertexBatch
 {
+public:
+    virtual ~VertexBatch() = default;
+
+    // Vertices of the elements whose bounds intersect `visible`, or of all elements if there is no such rectangle.
+    virtual auto vertices(const Style& style, const std::optional<sf::FloatRect>& visible) -> const sf::VertexArray& = 0;
+
+    // Bounds of the geometry, not including the outline.
+    virtual auto bounds() const -> sf::FloatRect = 0;
+
+    // Number of elements, and of those included by the last call to `vertices`.
+    virtual auto size() const -> std::size_t = 0;
+    virtual auto visible_size() const -> std::size_t = 0;
+};
+
+class DrawOp;
+
+// Modification of the drawing state, stored as a list of opcodes.
+class StateModifier
+{
+public:
     using Modifier = std::function<void(State&)>;
 
-    template <class M>
-    StateModifier(M&& modifier) : m_modifiers{ std::forward<M>(modifier) }
+    template <
+        class M,
+        std::enable_if_t<
+            !std::is_same_v<std::decay_t<M>, StateModifier> && std::is_invocable_v<const std::decay_t<M>&, State&>,
+            int> = 0>
+    StateModifier(M&& modifier)
     {
+        m_modifiers.emplace_back(std::forward<M>(modifier));
+        m_commands.push_back(detail::ModifyState{ 0 });
     }
 
     StateModifier(const StateModifier&) = default;
     StateModifier(StateModifier&&) noexcept = default;
 
-    void operator()(State& state) const
+    static auto of(const detail::Command& command) -> StateModifier
     {
-        for (const auto& modifier : m_modifiers)
-        {
-            modifier(state);
-        }
+        StateModifier result;
+        result.m_commands.push_back(command);
+        return result;
     }
 
+    void operator()(State& state) const;
+
     friend auto operator|(StateModifier lhs, StateModifier rhs) -> StateModifier
     {
-        lhs.m_modifiers.reserve(lhs.m_modifiers.size() + rhs.m_modifiers.size());
+        const detail::Rebase rebase{ 0, 0, 0, static_cast<std::uint32_t>(lhs.m_modifiers.size()) };
+        for (detail::Command command : rhs.m_commands)
+        {
+            rebase(command);
+            lhs.m_commands.push_back(command);
+        }
         lhs.m_modifiers.insert(
             lhs.m_modifiers.end(),
             std::make_move_iterator(rhs.m_modifiers.begin()),
@@ -100,7 +418,440 @@ struct StateModifier
     }
 
 private:
-    std::vector<Modifier> m_modifiers;
+    friend class DrawOp;
+    friend auto operator|(DrawOp item, StateModifier modifier) -> DrawOp;
+
+    StateModifier() = default;
+
+    detail::Commands m_commands;
+    std::pmr::vector<Modifier> m_modifiers{ frame_resource() };
+};
+
+namespace detail
+{
+
+// Applies state opcodes to `state`; returns false for anything else.
+struct ApplyState
+{
+    State& state;
+    const std::pmr::vector<StateModifier::Modifier>& modifiers;
+
+    bool operator()(const SetFillColor& c) const
+    {
+        state.style.fill_color = c.value;
+        return true;
+    }
+
+    bool operator()(const SetOutlineColor& c) const
+    {
+        state.style.outline_color = c.value;
+        return true;
+    }
+
+    bool operator()(const SetOutlineThickness& c) const
+    {
+        state.style.outline_thickness = c.value;
+        return true;
+    }
+
+    bool operator()(const SetTextStyle& c) const
+    {
+        state.text_style.style = c.value;
+        return true;
+    }
+
+    bool operator()(const AddTextStyle& c) const
+    {
+        state.text_style.style |= c.value;
+        return true;
+    }
+
+    bool operator()(const SetFont& c) const
+    {
+        state.text_style.font = *c.value;
+        return true;
+    }
+
+    bool operator()(const SetFontSize& c) const
+    {
+        state.text_style.font_size = c.value;
+        return true;
+    }
+
+    bool operator()(const SetBlendMode& c) const
+    {
+        state.render_states.blendMode = c.value;
+        return true;
+    }
+
+    bool operator()(const Translate& c) const
+    {
+        state.render_states.transform.translate(c.value);
+        return true;
+    }
+
+    bool operator()(const Scale& c) const
+    {
+        state.render_states.transform.scale(c.value);
+        return true;
+    }
+
+    bool operator()(const Rotate& c) const
+    {
+        state.render_states.transform.rotate(sf::radians(c.value));
+        return true;
+    }
+
+    bool operator()(const ModifyState& c) const
+    {
+        modifiers[c.index](state);
+        return true;
+    }
+
+    template <class Command>
+    bool operator()(const Command&) const
+    {
+        return false;
+    }
+};
+
+inline bool apply(State& state, const Command& command, const std::pmr::vector<StateModifier::Modifier>& modifiers)
+{
+    return std::visit(ApplyState{ state, modifiers }, command);
+}
+
+}  // namespace detail
+
+inline void StateModifier::operator()(State& state) const
+{
+    for (const detail::Command& command : m_commands)
+    {
+        detail::apply(state, command, m_modifiers);
+    }
+}
+
+// Drawing operation: a flat list of primitive and state opcodes interpreted against a stack of states.
+// Composing ops with `group`, `transform` or `|` appends to the list instead of nesting closures.
+class DrawOp
+{
+public:
+    using Callback = std::function<void(Context&, const State&)>;
+
+    DrawOp() = default;
+
+    template <
+        class F,
+        std::enable_if_t<
+            !std::is_same_v<std::decay_t<F>, DrawOp>
+                && std::is_invocable_v<const std::decay_t<F>&, Context&, const State&>,
+            int> = 0>
+    DrawOp(F&& callback)
+    {
+        m_callbacks.emplace_back(std::forward<F>(callback));
+        m_commands.push_back(detail::Call{ 0 });
+    }
+
+    explicit DrawOp(const detail::Command& command)
+    {
+        m_commands.push_back(command);
+    }
+
+    std::size_t size() const
+    {
+        return m_commands.size();
+    }
+
+    // Stores polygon vertices in the pool, returns the opcode drawing them.
+    template <class Range>
+    auto store_polygon(const Range& vertices) -> detail::DrawPolygon
+    {
+        const auto offset = static_cast<std::uint32_t>(m_points.size());
+        for (const auto& v : vertices)
+        {
+            m_points.push_back(convert(v));
+        }
+        const auto count = static_cast<std::uint32_t>(m_points.size() - offset);
+        return detail::DrawPolygon{ offset, count, detail::bounds(m_points.data() + offset, count) };
+    }
+
+    auto store_text(sf::String str) -> detail::DrawText
+    {
+        m_texts.push_back(std::move(str));
+        return detail::DrawText{ static_cast<std::uint32_t>(m_texts.size() - 1) };
+    }
+
+    auto store_batch(std::shared_ptr<VertexBatch> batch) -> detail::DrawBatch
+    {
+        m_batches.push_back(std::move(batch));
+        return detail::DrawBatch{ static_cast<std::uint32_t>(m_batches.size() - 1) };
+    }
+
+    void emit(const detail::Command& command)
+    {
+        m_commands.push_back(command);
+    }
+
+    void reserve(std::size_t commands)
+    {
+        m_commands.reserve(commands);
+    }
+
+    void append(DrawOp other)
+    {
+        if (m_commands.empty() && m_points.empty() && m_texts.empty() && m_callbacks.empty() && m_modifiers.empty()
+            && m_batches.empty())
+        {
+            *this = std::move(other);
+            return;
+        }
+        const detail::Rebase rebase{ static_cast<std::uint32_t>(m_points.size()),
+                                     static_cast<std::uint32_t>(m_texts.size()),
+                                     static_cast<std::uint32_t>(m_callbacks.size()),
+                                     static_cast<std::uint32_t>(m_modifiers.size()),
+                                     static_cast<std::uint32_t>(m_batches.size()) };
+        for (detail::Command& command : other.m_commands)
+        {
+            rebase(command);
+        }
+        m_commands.insert(m_commands.size(), other.m_commands.begin(), other.m_commands.size());
+        move_append(m_points, other.m_points);
+        move_append(m_texts, other.m_texts);
+        move_append(m_callbacks, other.m_callbacks);
+        move_append(m_modifiers, other.m_modifiers);
+        move_append(m_batches, other.m_batches);
+        m_depth = std::max(m_depth, other.m_depth);
+        m_scoped = false;
+    }
+
+    // Wraps the op in a push/pop scope applying `modifier` first. An op that already is a single scope gets the
+    // modifier prepended to its own, since outer modifiers are applied before inner ones.
+    friend auto operator|(DrawOp item, StateModifier modifier) -> DrawOp
+    {
+        const detail::Rebase rebase{ 0, 0, 0, static_cast<std::uint32_t>(item.m_modifiers.size()) };
+        for (detail::Command& command : modifier.m_commands)
+        {
+            rebase(command);
+        }
+        move_append(item.m_modifiers, modifier.m_modifiers);
+
+        if (item.m_scoped)
+        {
+            item.m_commands.insert(1, modifier.m_commands.begin(), modifier.m_commands.size());
+            return item;
+        }
+
+        detail::Commands commands;
+        commands.reserve(item.m_commands.size() + modifier.m_commands.size() + 2);
+        commands.push_back(detail::PushState{});
+        commands.insert(commands.size(), modifier.m_commands.begin(), modifier.m_commands.size());
+        commands.insert(commands.size(), item.m_commands.begin(), item.m_commands.size());
+        commands.push_back(detail::PopState{});
+        item.m_commands = std::move(commands);
+        item.m_depth += 1;
+        item.m_scoped = true;
+        return item;
+    }
+
+    void operator()(Context& ctx, const State& state) const
+    {
+        std::pmr::vector<State> stack{ frame_resource() };
+        stack.reserve(m_depth + 1);
+        stack.push_back(state);
+        for (const detail::Command& command : m_commands)
+        {
+            if (detail::apply(stack.back(), command, m_modifiers))
+            {
+                continue;
+            }
+            std::visit(
+                detail::overloaded{ [&](const detail::PushState&) { stack.push_back(stack.back()); },
+                                    [&](const detail::PopState&) { stack.pop_back(); },
+                                    [&](const auto& primitive)
+                                    {
+                                        if (visible(ctx, stack.back(), primitive))
+                                        {
+                                            ++ctx.stats.drawn;
+                                            draw(ctx, stack.back(), primitive);
+                                        }
+                                        else
+                                        {
+                                            ctx.stats.culled += elements(primitive);
+                                        }
+                                    } },
+                command);
+        }
+    }
+
+private:
+    template <class T>
+    static void move_append(std::pmr::vector<T>& dst, std::pmr::vector<T>& src)
+    {
+        dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+    }
+
+    // Local bounds of a primitive, or nothing if unknown without building it.
+    auto bounds(const detail::DrawRect& c) const -> std::optional<sf::FloatRect>
+    {
+        return sf::FloatRect{ {}, c.size };
+    }
+
+    auto bounds(const detail::DrawCircle& c) const -> std::optional<sf::FloatRect>
+    {
+        return sf::FloatRect{ {}, { 2.F * c.radius, 2.F * c.radius } };
+    }
+
+    auto bounds(const detail::DrawTriangle& c) const -> std::optional<sf::FloatRect>
+    {
+        return detail::bounds(c.vertices.data(), c.vertices.size());
+    }
+
+    auto bounds(const detail::DrawPolygon& c) const -> std::optional<sf::FloatRect>
+    {
+        return c.bounds;
+    }
+
+    auto bounds(const detail::DrawBatch& c) const -> std::optional<sf::FloatRect>
+    {
+        return m_batches[c.index]->bounds();
+    }
+
+    template <class Command>
+    auto bounds(const Command&) const -> std::optional<sf::FloatRect>
+    {
+        return std::nullopt;
+    }
+
+    // Number of primitives a command stands for in `Context::stats`.
+    auto elements(const detail::DrawBatch& c) const -> std::size_t
+    {
+        return m_batches[c.index]->size();
+    }
+
+    template <class Command>
+    auto elements(const Command&) const -> std::size_t
+    {
+        return 1;
+    }
+
+    static auto view_bounds(Context& ctx) -> const sf::FloatRect&
+    {
+        if (!ctx.view_bounds)
+        {
+            const sf::View& view = ctx.target.getView();
+            ctx.view_bounds = view.getInverseTransform().transformRect(sf::FloatRect{ { -1.F, -1.F }, { 2.F, 2.F } });
+        }
+        return *ctx.view_bounds;
+    }
+
+    static auto padded(const sf::FloatRect& rect, const State& state) -> sf::FloatRect
+    {
+        const float pad = std::max(state.style.outline_thickness, 0.F);
+        return sf::FloatRect{ rect.position - sf::Vector2f{ pad, pad }, rect.size + sf::Vector2f{ 2 * pad, 2 * pad } };
+    }
+
+    template <class Command>
+    bool visible(Context& ctx, const State& state, const Command& command) const
+    {
+        if (!ctx.culling)
+        {
+            return true;
+        }
+        const std::optional<sf::FloatRect> local = bounds(command);
+        if (!local)
+        {
+            return true;
+        }
+        return detail::intersects(state.render_states.transform.transformRect(padded(*local, state)), view_bounds(ctx));
+    }
+
+    // The view in local coordinates, grown by the outline so that elements can be tested by their bounds alone.
+    static auto local_view(Context& ctx, const State& state) -> std::optional<sf::FloatRect>
+    {
+        if (!ctx.culling)
+        {
+            return std::nullopt;
+        }
+        return padded(state.render_states.transform.getInverse().transformRect(view_bounds(ctx)), state);
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawText& c) const
+    {
+        sf::Text shape{ state.text_style.font, m_texts[c.index] };
+        shape.setFillColor(state.style.fill_color);
+        shape.setOutlineColor(state.style.outline_color);
+        shape.setOutlineThickness(state.style.outline_thickness);
+        shape.setCharacterSize(state.text_style.font_size);
+        shape.setLetterSpacing(state.text_style.letter_spacing);
+        shape.setLineSpacing(state.text_style.line_spacing);
+        shape.setStyle(state.text_style.style);
+        ctx.draw(shape, state.render_states);
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawRect& c) const
+    {
+        sf::RectangleShape shape(c.size);
+        apply_style(shape, state.style);
+        ctx.draw(shape, state.render_states);
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawCircle& c) const
+    {
+        sf::CircleShape shape(c.radius);
+        apply_style(shape, state.style);
+        ctx.draw(shape, state.render_states);
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawTriangle& c) const
+    {
+        draw_convex(ctx, state, c.vertices.data(), c.vertices.size());
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawPolygon& c) const
+    {
+        draw_convex(ctx, state, m_points.data() + c.offset, c.count);
+    }
+
+    void draw(Context& ctx, const State& state, const detail::DrawBatch& c) const
+    {
+        VertexBatch& batch = *m_batches[c.index];
+        ctx.draw(batch.vertices(state.style, local_view(ctx, state)), state.render_states);
+        // Counted as a single primitive by the caller; count its elements instead.
+        ctx.stats.drawn = ctx.stats.drawn - 1 + batch.visible_size();
+        ctx.stats.culled += batch.size() - batch.visible_size();
+    }
+
+    void draw(Context& ctx, const State& state, const detail::Call& c) const
+    {
+        m_callbacks[c.index](ctx, state);
+    }
+
+    template <class Command>
+    void draw(Context&, const State&, const Command&) const
+    {
+        // state opcodes are handled by `detail::apply`
+    }
+
+    static void draw_convex(Context& ctx, const State& state, const sf::Vector2f* vertices, std::size_t count)
+    {
+        sf::ConvexShape shape{};
+        shape.setPointCount(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            shape.setPoint(i, vertices[i]);
+        }
+        apply_style(shape, state.style);
+        ctx.draw(shape, state.render_states);
+    }
+
+    // Pools are allocated from the frame resource active when the op was created.
+    detail::Commands m_commands;
+    std::pmr::vector<sf::Vector2f> m_points{ frame_resource() };
+    std::pmr::vector<sf::String> m_texts{ frame_resource() };
+    std::pmr::vector<Callback> m_callbacks{ frame_resource() };
+    std::pmr::vector<StateModifier::Modifier> m_modifiers{ frame_resource() };
+    std::pmr::vector<std::shared_ptr<VertexBatch>> m_batches{ frame_resource() };
+    std::size_t m_depth = 0;  // maximum nesting of push/pop scopes
+    bool m_scoped = false;    // the whole list is a single push/pop scope
 };
 
 struct StyleModifier : public std::function<void(Style&)>
@@ -121,23 +872,6 @@ struct RenderStatesModifier : public std::function<void(sf::RenderStates&)>
     using base_t::base_t;
 };
 
-inline auto operator|(DrawOp item, StateModifier modifier) -> DrawOp
-{
-    return [item = std::move(item), modifier = std::move(modifier)](Context& ctx, const State& state)
-    {
-        State new_state = state;
-        modifier(new_state);
-        item(ctx, new_state);
-    };
-}
-
-inline void apply_style(sf::Shape& shape, const Style& style)
-{
-    shape.setFillColor(style.fill_color);
-    shape.setOutlineColor(style.outline_color);
-    shape.setOutlineThickness(style.outline_thickness);
-}
-
 inline auto modify_style(StyleModifier style_modifier) -> StateModifier
 {
     return [sm = std::move(style_modifier)](State& state) { sm(state.style); };
@@ -155,32 +889,32 @@ inline auto modify_render_states(RenderStatesModifier render_states_modifier) ->
 
 inline auto text_style(std::uint32_t value) -> StateModifier
 {
-    return modify_text_style([=](TextStyle& text_style) { text_style.style = value; });
+    return StateModifier::of(detail::SetTextStyle{ value });
 }
 
 inline auto bold() -> StateModifier
 {
-    return modify_text_style([=](TextStyle& text_style) { text_style.style |= sf::Text::Bold; });
+    return StateModifier::of(detail::AddTextStyle{ sf::Text::Bold });
 }
 
 inline auto italic() -> StateModifier
 {
-    return modify_text_style([=](TextStyle& text_style) { text_style.style |= sf::Text::Italic; });
+    return StateModifier::of(detail::AddTextStyle{ sf::Text::Italic });
 }
 
 inline auto underlined() -> StateModifier
 {
-    return modify_text_style([=](TextStyle& text_style) { text_style.style |= sf::Text::Underlined; });
+    return StateModifier::of(detail::AddTextStyle{ sf::Text::Underlined });
 }
 
 inline auto fill_color(const sf::Color& color) -> StateModifier
 {
-    return modify_style([=](Style& style) { style.fill_color = color; });
+    return StateModifier::of(detail::SetFillColor{ color });
 }
 
 inline auto outline_color(const sf::Color& color) -> StateModifier
 {
-    return modify_style([=](Style& style) { style.outline_color = color; });
+    return StateModifier::of(detail::SetOutlineColor{ color });
 }
 
 inline auto color(const sf::Color& color) -> StateModifier
@@ -190,32 +924,32 @@ inline auto color(const sf::Color& color) -> StateModifier
 
 inline auto outline_thickness(float value) -> StateModifier
 {
-    return modify_style([=](Style& style) { style.outline_thickness = value; });
+    return StateModifier::of(detail::SetOutlineThickness{ value });
 }
 
 inline auto font(const sf::Font& value) -> StateModifier
 {
-    return modify_text_style([&](TextStyle& text_style) { text_style.font = value; });
+    return StateModifier::of(detail::SetFont{ &value });
 }
 
 inline auto font_size(std::uint32_t value) -> StateModifier
 {
-    return modify_text_style([=](TextStyle& text_style) { text_style.font_size = value; });
+    return StateModifier::of(detail::SetFontSize{ value });
 }
 
 inline auto blend(sf::BlendMode mode) -> StateModifier
 {
-    return modify_render_states([=](sf::RenderStates& render_states) { render_states.blendMode = mode; });
+    return StateModifier::of(detail::SetBlendMode{ mode });
 }
 
 inline auto translate(const zx::mat::vector_t<float, 2>& v) -> StateModifier
 {
-    return modify_render_states([=](sf::RenderStates& render_states) { render_states.transform.translate(convert(v)); });
+    return StateModifier::of(detail::Translate{ convert(v) });
 }
 
 inline auto scale(const zx::mat::vector_t<float, 2>& v) -> StateModifier
 {
-    return modify_render_states([=](sf::RenderStates& render_states) { render_states.transform.scale(convert(v)); });
+    return StateModifier::of(detail::Scale{ convert(v) });
 }
 
 inline auto scale(const zx::mat::vector_t<float, 2>& v, const zx::mat::vector_t<float, 2>& pivot) -> StateModifier
@@ -225,7 +959,7 @@ inline auto scale(const zx::mat::vector_t<float, 2>& v, const zx::mat::vector_t<
 
 inline auto rotate(float a) -> StateModifier
 {
-    return modify_render_states([=](sf::RenderStates& render_states) { render_states.transform.rotate(sf::radians(a)); });
+    return StateModifier::of(detail::Rotate{ a });
 }
 
 inline auto rotate(float a, const zx::mat::vector_t<float, 2>& pivot) -> StateModifier
@@ -235,87 +969,101 @@ inline auto rotate(float a, const zx::mat::vector_t<float, 2>& pivot) -> StateMo
 
 inline auto empty_item() -> DrawOp
 {
-    return [](Context&, const State&) {};
+    return DrawOp{};
 }
 
 inline auto group(std::vector<DrawOp> items) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
+    DrawOp result;
+    for (auto& item : items)
     {
-        for (const auto& item : items)
-        {
-            item(ctx, state);
-        }
-    };
+        result.append(std::move(item));
+    }
+    return result;
 }
 
 template <class... Tail>
 auto group(DrawOp head, Tail... tail) -> DrawOp
 {
-    std::vector<DrawOp> items{ std::move(head), DrawOp(std::move(tail))... };
-    return group(std::move(items));
+    (head.append(DrawOp(std::move(tail))), ...);
+    return head;
 }
 
 template <class Func, class Range>
 auto transform(Func&& func, Range&& range) -> DrawOp
 {
-    std::vector<DrawOp> items;
+    DrawOp result;
     for (auto&& item : range)
     {
-        items.push_back(std::invoke(func, item));
+        result.append(std::invoke(func, item));
     }
-    return group(std::move(items));
+    return result;
 }
 
 template <class Func, class Range>
 auto transform_maybe(Func&& func, Range&& range) -> DrawOp
 {
-    std::vector<DrawOp> items;
+    DrawOp result;
     for (auto&& item : range)
     {
         std::optional<DrawOp> res = std::invoke(func, item);
         if (res)
         {
-            items.push_back(*std::move(res));
+            result.append(*std::move(res));
         }
     }
-    return group(std::move(items));
+    return result;
 }
 
-inline auto text(const sf::String& str) -> DrawOp
+// Draws `item` without copying it; `item` must outlive the returned op.
+inline auto ref(const DrawOp& item) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
+    return [ptr = &item](Context& ctx, const State& state) { (*ptr)(ctx, state); };
+}
+
+// Retained draw op: rebuilt only when the version it was built for changes, so that static sub-trees are not
+// reconstructed every frame.
+class RetainedOp
+{
+public:
+    template <class Build>
+    auto get(std::uint64_t version, Build&& build) -> const DrawOp&
     {
-        sf::Text shape{ state.text_style.font, str };
-        shape.setFillColor(state.style.fill_color);
-        shape.setOutlineColor(state.style.outline_color);
-        shape.setOutlineThickness(state.style.outline_thickness);
-        shape.setCharacterSize(state.text_style.font_size);
-        shape.setLetterSpacing(state.text_style.letter_spacing);
-        shape.setLineSpacing(state.text_style.line_spacing);
-        shape.setStyle(state.text_style.style);
-        ctx.target.draw(shape, state.render_states);
-    };
+        if (!m_item || m_version != version)
+        {
+            // Outlives the frame, so it must not be allocated from the frame arena.
+            const FrameResourceScope scope{ std::pmr::new_delete_resource() };
+            m_item = std::invoke(std::forward<Build>(build));
+            m_version = version;
+        }
+        return *m_item;
+    }
+
+    void invalidate()
+    {
+        m_item.reset();
+    }
+
+private:
+    std::optional<DrawOp> m_item = {};
+    std::uint64_t m_version = 0;
+};
+
+inline auto text(const sf::String& str) -> DrawOp
+{
+    DrawOp result;
+    result.emit(result.store_text(str));
+    return result;
 }
 
 inline auto rect(const zx::mat::vector_t<float, 2>& size) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
-    {
-        sf::RectangleShape shape(convert(size));
-        apply_style(shape, state.style);
-        ctx.target.draw(shape, state.render_states);
-    };
+    return DrawOp{ detail::DrawRect{ convert(size) } };
 }
 
 inline auto circle(float r) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
-    {
-        sf::CircleShape shape(r);
-        apply_style(shape, state.style);
-        ctx.target.draw(shape, state.render_states);
-    };
+    return DrawOp{ detail::DrawCircle{ r } };
 }
 
 inline auto circle(const zx::mat::spherical_shape_t<float, 2>& c) -> DrawOp
@@ -334,7 +1082,7 @@ inline auto sprite(const sf::Texture& texture, const sf::IntRect& rect) -> DrawO
     {
         sf::Sprite shape{ texture };
         shape.setTextureRect(rect);
-        ctx.target.draw(shape, state.render_states);
+        ctx.draw(shape, state.render_states);
     };
 }
 
@@ -349,7 +1097,7 @@ inline auto grid(const zx::mat::vector_t<float, 2>& size, const zx::mat::vector_
             line[0].color = state.style.outline_color;
             line[1].position = sf::Vector2f(i, size[1]);
             line[1].color = state.style.outline_color;
-            ctx.target.draw(line, 2, sf::PrimitiveType::Lines, state.render_states);
+            ctx.draw(line, 2, sf::PrimitiveType::Lines, state.render_states);
         }
         for (int i = 0; i < size[1]; i += dist[1])
         {
@@ -358,24 +1106,14 @@ inline auto grid(const zx::mat::vector_t<float, 2>& size, const zx::mat::vector_
             line[0].color = state.style.outline_color;
             line[1].position = sf::Vector2f(size[0], i);
             line[1].color = state.style.outline_color;
-            ctx.target.draw(line, 2, sf::PrimitiveType::Lines, state.render_states);
+            ctx.draw(line, 2, sf::PrimitiveType::Lines, state.render_states);
         }
     };
 }
 
 inline auto triangle(const std::array<zx::mat::vector_t<float, 2>, 3>& vertices) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
-    {
-        sf::ConvexShape shape{};
-        shape.setPointCount(vertices.size());
-        for (std::size_t i = 0; i < vertices.size(); ++i)
-        {
-            shape.setPoint(i, convert(vertices[i]));
-        }
-        apply_style(shape, state.style);
-        ctx.target.draw(shape, state.render_states);
-    };
+    return DrawOp{ detail::DrawTriangle{ { convert(vertices[0]), convert(vertices[1]), convert(vertices[2]) } } };
 }
 
 inline auto triangle(
@@ -387,17 +1125,292 @@ inline auto triangle(
 
 inline auto polygon(const std::vector<zx::mat::vector_t<float, 2>>& vertices) -> DrawOp
 {
-    return [=](Context& ctx, const State& state)
+    DrawOp result;
+    result.emit(result.store_polygon(vertices));
+    return result;
+}
+
+namespace detail
+{
+
+// Segments drawn in a single call, culled by element: a segment, or the outline of a polygon. The vertex array is
+// regenerated only when the outline style or the visible rectangle changes.
+class LineBatch : public VertexBatch
+{
+public:
+    // `ends[i]` is the end of the i-th element in `endpoints`; by default, every segment is an element.
+    explicit LineBatch(std::vector<sf::Vector2f> endpoints, std::vector<std::uint32_t> ends = {})
+        : m_endpoints(std::move(endpoints))
+        , m_ends(std::move(ends))
+        , m_bounds(detail::bounds(m_endpoints.data(), m_endpoints.size()))
     {
-        sf::ConvexShape shape{};
-        shape.setPointCount(vertices.size());
-        for (std::size_t i = 0; i < vertices.size(); ++i)
+        if (m_ends.empty())
         {
-            shape.setPoint(i, convert(vertices[i]));
+            for (std::size_t i = 2; i <= m_endpoints.size(); i += 2)
+            {
+                m_ends.push_back(static_cast<std::uint32_t>(i));
+            }
         }
-        apply_style(shape, state.style);
-        ctx.target.draw(shape, state.render_states);
-    };
+        m_element_bounds.reserve(m_ends.size());
+        std::uint32_t begin = 0;
+        for (const std::uint32_t end : m_ends)
+        {
+            m_element_bounds.push_back(detail::bounds(m_endpoints.data() + begin, end - begin));
+            begin = end;
+        }
+    }
+
+    auto bounds() const -> sf::FloatRect override
+    {
+        return m_bounds;
+    }
+
+    auto size() const -> std::size_t override
+    {
+        return m_ends.size();
+    }
+
+    auto visible_size() const -> std::size_t override
+    {
+        return m_visible_size;
+    }
+
+    auto vertices(const Style& style, const std::optional<sf::FloatRect>& visible) -> const sf::VertexArray& override
+    {
+        if (!m_built || style.outline_color != m_color || style.outline_thickness != m_thickness || visible != m_visible)
+        {
+            build(style.outline_color, style.outline_thickness, visible);
+        }
+        return m_vertices;
+    }
+
+private:
+    // Hairlines become `Lines`; thicker outlines become two triangles per segment.
+    void build(const sf::Color& color, float thickness, const std::optional<sf::FloatRect>& visible)
+    {
+        m_color = color;
+        m_thickness = thickness;
+        m_visible = visible;
+        m_built = true;
+        m_visible_size = 0;
+
+        const bool hairline = thickness <= 1.F;
+        m_vertices.setPrimitiveType(hairline ? sf::PrimitiveType::Lines : sf::PrimitiveType::Triangles);
+        m_vertices.resize(m_endpoints.size() / 2 * (hairline ? 2 : 6));
+        std::size_t v = 0;
+        const auto emit = [&](sf::Vector2f position)
+        {
+            m_vertices[v].position = position;
+            m_vertices[v].color = color;
+            ++v;
+        };
+
+        std::uint32_t begin = 0;
+        for (std::size_t e = 0; e < m_ends.size(); begin = m_ends[e++])
+        {
+            if (visible && !detail::intersects(m_element_bounds[e], *visible))
+            {
+                continue;
+            }
+            ++m_visible_size;
+            for (std::size_t i = begin; i + 1 < m_ends[e]; i += 2)
+            {
+                const sf::Vector2f a = m_endpoints[i];
+                const sf::Vector2f b = m_endpoints[i + 1];
+                if (hairline)
+                {
+                    emit(a);
+                    emit(b);
+                    continue;
+                }
+                const sf::Vector2f d = b - a;
+                const float length = std::sqrt(d.x * d.x + d.y * d.y);
+                const sf::Vector2f n
+                    = length > 0.F ? sf::Vector2f{ -d.y, d.x } * (0.5F * thickness / length) : sf::Vector2f{};
+                for (const sf::Vector2f& p : { a + n, b + n, b - n, a + n, b - n, a - n })
+                {
+                    emit(p);
+                }
+            }
+        }
+        m_vertices.resize(v);
+    }
+
+    std::vector<sf::Vector2f> m_endpoints;
+    std::vector<std::uint32_t> m_ends;  // end of each element in `m_endpoints`
+    std::vector<sf::FloatRect> m_element_bounds = {};
+    sf::FloatRect m_bounds;
+    sf::VertexArray m_vertices = {};
+    sf::Color m_color = {};
+    float m_thickness = 0.F;
+    std::optional<sf::FloatRect> m_visible = {};
+    std::size_t m_visible_size = 0;
+    bool m_built = false;
+};
+
+}  // namespace detail
+
+// Segments given as consecutive pairs of endpoints, drawn with the outline style in a single draw call.
+inline auto line_batch(std::vector<sf::Vector2f> endpoints) -> DrawOp
+{
+    DrawOp result;
+    result.emit(result.store_batch(std::make_shared<detail::LineBatch>(std::move(endpoints))));
+    return result;
+}
+
+// Outlines of all polygons in `range` in a single draw call, culled by polygon. Unlike `polygon`, the fill is not drawn.
+template <class Range>
+auto polygons(const Range& range) -> DrawOp
+{
+    std::vector<sf::Vector2f> endpoints;
+    std::vector<std::uint32_t> ends;
+    for (const auto& vertices : range)
+    {
+        const std::size_t size = std::size(vertices);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            endpoints.push_back(convert(vertices[i]));
+            endpoints.push_back(convert(vertices[(i + 1) % size]));
+        }
+        ends.push_back(static_cast<std::uint32_t>(endpoints.size()));
+    }
+    DrawOp result;
+    result.emit(result.store_batch(std::make_shared<detail::LineBatch>(std::move(endpoints), std::move(ends))));
+    return result;
+}
+
+// Vertex buffer for drawing many equally sized circles in a single call, each as a `segments`-gon with an optional
+// outline ring. Meant to be kept between frames: refilling it reuses the storage.
+class PointBatch : public VertexBatch
+{
+public:
+    explicit PointBatch(std::size_t segments = 8) : m_offsets(segments)
+    {
+        for (std::size_t i = 0; i < segments; ++i)
+        {
+            const float angle = 2.F * 3.14159265F * static_cast<float>(i) / static_cast<float>(segments);
+            m_offsets[i] = sf::Vector2f{ std::cos(angle), std::sin(angle) };
+        }
+    }
+
+    template <class Range, class Proj>
+    void assign(const Range& range, float radius, Proj&& proj)
+    {
+        m_centers.clear();
+        for (const auto& item : range)
+        {
+            m_centers.push_back(convert(std::invoke(proj, item)));
+        }
+        m_radius = radius;
+        m_built = false;
+
+        const sf::FloatRect centers = detail::bounds(m_centers.data(), m_centers.size());
+        m_bounds = sf::FloatRect{ centers.position - sf::Vector2f{ radius, radius },
+                                  centers.size + sf::Vector2f{ 2 * radius, 2 * radius } };
+    }
+
+    auto bounds() const -> sf::FloatRect override
+    {
+        return m_bounds;
+    }
+
+    auto size() const -> std::size_t override
+    {
+        return m_centers.size();
+    }
+
+    auto visible_size() const -> std::size_t override
+    {
+        return m_visible_size;
+    }
+
+    auto vertices(const Style& style, const std::optional<sf::FloatRect>& visible) -> const sf::VertexArray& override
+    {
+        if (!m_built || style.fill_color != m_style.fill_color || style.outline_color != m_style.outline_color
+            || style.outline_thickness != m_style.outline_thickness || visible != m_visible)
+        {
+            build(style, visible);
+        }
+        return m_vertices;
+    }
+
+private:
+    void build(const Style& style, const std::optional<sf::FloatRect>& visible)
+    {
+        m_style = style;
+        m_visible = visible;
+        m_built = true;
+        m_visible_size = 0;
+
+        const std::size_t segments = m_offsets.size();
+        const bool outlined = style.outline_thickness > 0.F;
+        const std::size_t per_point = segments * (outlined ? 9 : 3);
+        m_vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+        m_vertices.resize(m_centers.size() * per_point);
+
+        std::size_t v = 0;
+        const auto emit = [&](sf::Vector2f position, const sf::Color& color)
+        {
+            m_vertices[v].position = position;
+            m_vertices[v].color = color;
+            ++v;
+        };
+        const float outer = m_radius + style.outline_thickness;
+        const sf::Vector2f extent{ m_radius, m_radius };
+        for (const sf::Vector2f& center : m_centers)
+        {
+            if (visible && !detail::intersects(sf::FloatRect{ center - extent, extent * 2.F }, *visible))
+            {
+                continue;
+            }
+            ++m_visible_size;
+            for (std::size_t i = 0; i < segments; ++i)
+            {
+                const sf::Vector2f a = m_offsets[i];
+                const sf::Vector2f b = m_offsets[(i + 1) % segments];
+                emit(center, style.fill_color);
+                emit(center + a * m_radius, style.fill_color);
+                emit(center + b * m_radius, style.fill_color);
+                if (outlined)
+                {
+                    emit(center + a * m_radius, style.outline_color);
+                    emit(center + a * outer, style.outline_color);
+                    emit(center + b * outer, style.outline_color);
+                    emit(center + a * m_radius, style.outline_color);
+                    emit(center + b * outer, style.outline_color);
+                    emit(center + b * m_radius, style.outline_color);
+                }
+            }
+        }
+        m_vertices.resize(v);
+    }
+
+    std::vector<sf::Vector2f> m_offsets;
+    std::vector<sf::Vector2f> m_centers = {};
+    float m_radius = 0.F;
+    sf::FloatRect m_bounds = {};
+    sf::VertexArray m_vertices = {};
+    Style m_style = {};
+    std::optional<sf::FloatRect> m_visible = {};
+    std::size_t m_visible_size = 0;
+    bool m_built = false;
+};
+
+// Points drawn as circles of the given radius in a single call; `batch` is refilled and may be reused across frames.
+template <class Range, class Proj>
+auto points(std::shared_ptr<PointBatch> batch, const Range& range, float radius, Proj&& proj) -> DrawOp
+{
+    batch->assign(range, radius, std::forward<Proj>(proj));
+    DrawOp result;
+    result.emit(result.store_batch(std::move(batch)));
+    return result;
+}
+
+template <class Range>
+auto points(const Range& range, float radius = 3.F) -> DrawOp
+{
+    return points(
+        std::make_shared<PointBatch>(), range, radius, [](const zx::mat::vector_t<float, 2>& p) { return p; });
 }
 
 inline auto shape(const zx::mat::spherical_shape_t<float, 2>& item) -> DrawOp
@@ -420,7 +1433,7 @@ inline auto shape(const zx::mat::segment_t<float, 2>& item) -> DrawOp
             shape[i].position = convert(item[i]);
             shape[i].color = state.style.outline_color;
         }
-        ctx.target.draw(shape, state.render_states);
+        ctx.draw(shape, state.render_states);
     };
 }
 
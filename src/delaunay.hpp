@@ -0,0 +1,1027 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <zx/mat.hpp>
+
+namespace delaunay
+{
+
+// Sequence of values stored in fixed-size chunks that copies share until one of them modifies a chunk, so that a copy
+// costs one reference per chunk and later changes clone only the chunks they touch. Copies may be read from other
+// threads while the original is modified.
+template <class Value, std::size_t ChunkSize = 16>
+class shared_chunks
+{
+    static constexpr std::size_t chunk_size = ChunkSize;
+    using chunk_t = std::array<Value, chunk_size>;
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Value*;
+        using reference = const Value&;
+
+        const_iterator(const shared_chunks* owner, std::size_t index) : m_owner(owner), m_index(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*m_owner)[m_index];
+        }
+
+        pointer operator->() const
+        {
+            return &(*m_owner)[m_index];
+        }
+
+        const_iterator& operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator result = *this;
+            ++m_index;
+            return result;
+        }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return lhs.m_index == rhs.m_index;
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        const shared_chunks* m_owner;
+        std::size_t m_index;
+    };
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const Value& operator[](std::size_t i) const
+    {
+        return (*m_chunks[i / chunk_size])[i % chunk_size];
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator{ this, 0 };
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator{ this, m_size };
+    }
+
+    std::size_t capacity() const
+    {
+        return m_chunks.size() * chunk_size;
+    }
+
+    void reserve(std::size_t count)
+    {
+        while (capacity() < count)
+        {
+            m_chunks.push_back(std::make_shared<chunk_t>());
+        }
+    }
+
+    // Appends the slot past the end, which holds a default value unless it has been written through `mutate`.
+    // Allocates nothing if there is capacity left.
+    void emplace_back()
+    {
+        reserve(m_size + 1);
+        ++m_size;
+    }
+
+    void push_back(Value value)
+    {
+        emplace_back();
+        mutate(m_size - 1) = std::move(value);
+    }
+
+    // Element `i < capacity()` for writing; its chunk is cloned first if a copy still refers to it, so that calling
+    // this ahead of time makes later writes to the element allocation-free.
+    Value& mutate(std::size_t i)
+    {
+        std::shared_ptr<chunk_t>& chunk = m_chunks[i / chunk_size];
+        if (chunk.use_count() > 1)
+        {
+            chunk = std::make_shared<chunk_t>(*chunk);
+        }
+        else
+        {
+            // Copies may only have been dropped since; make their last reads happen before the writes that follow.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return (*chunk)[i % chunk_size];
+    }
+
+private:
+    std::vector<std::shared_ptr<chunk_t>> m_chunks = {};
+    std::size_t m_size = 0;
+};
+
+namespace detail
+{
+
+// Exact sum of doubles, kept as nonzero, nonoverlapping components in increasing order of magnitude, so that its sign
+// is the sign of the last one (Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric
+// Predicates"). Only used when the rounded evaluation of a predicate is too close to zero to trust its sign.
+class expansion
+{
+public:
+    explicit expansion(double value = 0.0)
+    {
+        grow(value);
+    }
+
+    // `a - b`, exactly.
+    static expansion difference(double a, double b)
+    {
+        expansion result;
+        double sum = 0.0;
+        double error = 0.0;
+        two_sum(a, -b, sum, error);
+        result.grow(error);
+        result.grow(sum);
+        return result;
+    }
+
+    int sign() const
+    {
+        return m_terms.empty() ? 0 : m_terms.back() > 0.0 ? 1 : -1;
+    }
+
+    expansion operator-() const
+    {
+        expansion result = *this;
+        for (double& term : result.m_terms)
+        {
+            term = -term;
+        }
+        return result;
+    }
+
+    friend expansion operator+(const expansion& lhs, const expansion& rhs)
+    {
+        expansion result = lhs;
+        for (const double term : rhs.m_terms)
+        {
+            result.grow(term);
+        }
+        return result;
+    }
+
+    friend expansion operator-(const expansion& lhs, const expansion& rhs)
+    {
+        return lhs + -rhs;
+    }
+
+    friend expansion operator*(const expansion& lhs, const expansion& rhs)
+    {
+        expansion result;
+        for (const double factor : rhs.m_terms)
+        {
+            for (const double term : lhs.m_terms)
+            {
+                const double product = term * factor;
+                result.grow(std::fma(term, factor, -product));  // the rounding error of `product`, exactly
+                result.grow(product);
+            }
+        }
+        return result;
+    }
+
+private:
+    static void two_sum(double a, double b, double& sum, double& error)
+    {
+        sum = a + b;
+        const double b_virtual = sum - a;
+        const double a_virtual = sum - b_virtual;
+        error = (a - a_virtual) + (b - b_virtual);
+    }
+
+    // Grow-Expansion with zero elimination: carries `value` up through the components, keeping the rounding errors.
+    void grow(double value)
+    {
+        std::size_t kept = 0;
+        for (const double term : m_terms)
+        {
+            double sum = 0.0;
+            double error = 0.0;
+            two_sum(value, term, sum, error);
+            value = sum;
+            if (error != 0.0)
+            {
+                m_terms[kept++] = error;
+            }
+        }
+        m_terms.resize(kept);
+        if (value != 0.0)
+        {
+            m_terms.push_back(value);
+        }
+    }
+
+    std::vector<double> m_terms = {};
+};
+
+using point_t = std::array<double, 2>;
+
+constexpr double epsilon = std::numeric_limits<double>::epsilon() / 2.0;  // relative rounding error of an operation
+
+// Twice the signed area of the triangle (a, b, c): positive if it is counter-clockwise, negative if clockwise and zero
+// if the points are collinear. The sign is exact; the magnitude is only approximate when it is close to zero.
+inline double orient(const point_t& a, const point_t& b, const point_t& c)
+{
+    constexpr double error_bound = (3.0 + 16.0 * epsilon) * epsilon;
+    const double left = (a[0] - c[0]) * (b[1] - c[1]);
+    const double right = (a[1] - c[1]) * (b[0] - c[0]);
+    const double det = left - right;
+    const double bound = error_bound * (std::abs(left) + std::abs(right));
+    if (det > bound || -det > bound)
+    {
+        return det;
+    }
+    const expansion exact = expansion::difference(a[0], c[0]) * expansion::difference(b[1], c[1])
+                            - expansion::difference(a[1], c[1]) * expansion::difference(b[0], c[0]);
+    return exact.sign();
+}
+
+// Positive if `d` lies inside the circle through the counter-clockwise triangle (a, b, c), negative if outside and zero
+// if on it. The sign is exact, as for `orient`.
+inline double in_circle(const point_t& a, const point_t& b, const point_t& c, const point_t& d)
+{
+    constexpr double error_bound = (10.0 + 96.0 * epsilon) * epsilon;
+    const double adx = a[0] - d[0];
+    const double ady = a[1] - d[1];
+    const double bdx = b[0] - d[0];
+    const double bdy = b[1] - d[1];
+    const double cdx = c[0] - d[0];
+    const double cdy = c[1] - d[1];
+
+    const double bdxcdy = bdx * cdy;
+    const double cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady;
+    const double adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy;
+    const double bdxady = bdx * ady;
+    const double alift = adx * adx + ady * ady;
+    const double blift = bdx * bdx + bdy * bdy;
+    const double clift = cdx * cdx + cdy * cdy;
+
+    const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift
+                             + (std::abs(cdxady) + std::abs(adxcdy)) * blift
+                             + (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+    const double bound = error_bound * permanent;
+    if (det > bound || -det > bound)
+    {
+        return det;
+    }
+
+    const expansion eadx = expansion::difference(a[0], d[0]);
+    const expansion eady = expansion::difference(a[1], d[1]);
+    const expansion ebdx = expansion::difference(b[0], d[0]);
+    const expansion ebdy = expansion::difference(b[1], d[1]);
+    const expansion ecdx = expansion::difference(c[0], d[0]);
+    const expansion ecdy = expansion::difference(c[1], d[1]);
+    const expansion exact = (eadx * eadx + eady * eady) * (ebdx * ecdy - ecdx * ebdy)
+                            + (ebdx * ebdx + ebdy * ebdy) * (ecdx * eady - eadx * ecdy)
+                            + (ecdx * ecdx + ecdy * ecdy) * (eadx * ebdy - ebdx * eady);
+    return exact.sign();
+}
+
+}  // namespace detail
+
+// Incremental Bowyer-Watson triangulation.
+// Every inserted site only touches the cavity of triangles whose circumcircles contain it; the Voronoi cells of the
+// sites on the cavity boundary are the only ones recomputed.
+// The hull is closed by ghost triangles joining each hull edge to a vertex at infinity, whose circumcircle is the open
+// half-plane beyond the edge, so sites may lie anywhere and every triangle of the sites is kept. The predicates are
+// exact, so cocircular and collinear sites, as on a grid, cannot break the mesh. Until three sites are not collinear,
+// the sites are only recorded, and the triangulation is built from all of them with the first one that is not.
+template <class T>
+class triangulation_t
+{
+public:
+    using point_type = zx::mat::vector_t<T, 2>;
+    using polygon_type = std::vector<point_type>;
+    using index_t = std::uint32_t;
+
+    static constexpr index_t npos = std::numeric_limits<index_t>::max();
+    static constexpr std::size_t mesh_chunk_size = 256;
+
+    triangulation_t() : triangulation_t(T{ 100000 })
+    {
+    }
+
+    // The unbounded Voronoi cells of the hull sites are closed `far` away from the last circumcenters on their sides.
+    explicit triangulation_t(T far) : m_far(static_cast<double>(far))
+    {
+        m_vertices.push_back(vertex_t{ 0.0, 0.0 });  // the vertex at infinity
+        m_vertex_face.push_back(npos);
+    }
+
+    // Inserts a site. Returns false, leaving the triangulation unchanged, for a duplicate of an already inserted site
+    // or a point with a non-finite coordinate. An insertion that throws (when memory runs out) also leaves it unchanged.
+    bool insert(const point_type& p)
+    {
+        const vertex_t v = { static_cast<double>(p[0]), static_cast<double>(p[1]) };
+        if (!std::isfinite(v[0]) || !std::isfinite(v[1]))
+        {
+            return false;
+        }
+        if (m_faces.empty())
+        {
+            return insert_collinear(p, v);
+        }
+
+        const index_t containing = locate(v);
+        for (const index_t vertex : m_faces[containing].vertices)
+        {
+            if (vertex != infinite && m_vertices[vertex] == v)
+            {
+                return false;
+            }
+        }
+
+        collect_cavity(containing, v);
+        reserve_insertion();
+        // Nothing below allocates, so the insertion cannot fail half-way.
+        const index_t new_vertex = append_site(p, v);
+        fill_cavity(new_vertex);
+        update_cells();
+        return true;
+    }
+
+    // Inserts a batch of sites in Hilbert-curve order so that consecutive point locations walk only a few faces.
+    // Returns the sites that were not inserted: non-finite points, then duplicates in insertion order.
+    template <class Range>
+    std::vector<point_type> insert(const Range& range)
+    {
+        std::vector<point_type> rejected;
+        m_scratch.batch.clear();
+        vertex_t min = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+        vertex_t max = { std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() };
+        for (const point_type& p : range)
+        {
+            const vertex_t v = { static_cast<double>(p[0]), static_cast<double>(p[1]) };
+            if (!std::isfinite(v[0]) || !std::isfinite(v[1]))
+            {
+                rejected.push_back(p);
+                continue;
+            }
+            m_scratch.batch.push_back({ std::uint64_t{ 0 }, p });
+            for (std::size_t axis = 0; axis < 2; ++axis)
+            {
+                min[axis] = std::min(min[axis], v[axis]);
+                max[axis] = std::max(max[axis], v[axis]);
+            }
+        }
+        for (auto& item : m_scratch.batch)
+        {
+            item.first = hilbert_index(item.second, min, max);
+        }
+        std::sort(
+            m_scratch.batch.begin(),
+            m_scratch.batch.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+        for (const auto& item : m_scratch.batch)
+        {
+            if (!insert(item.second))
+            {
+                rejected.push_back(item.second);
+            }
+        }
+        return rejected;
+    }
+
+    std::size_t size() const
+    {
+        return m_sites.size();
+    }
+
+    const shared_chunks<point_type, mesh_chunk_size>& sites() const
+    {
+        return m_sites;
+    }
+
+    // Voronoi cell of each site, in insertion order. Cells of sites on the convex hull are unbounded and closed `far`
+    // away (see the constructor); cells are empty while all sites are collinear.
+    const shared_chunks<polygon_type>& cells() const
+    {
+        return m_cells;
+    }
+
+    // Index of the site whose Voronoi cell contains `p`, i.e. its nearest site. Locates the enclosing triangle, then
+    // walks the Delaunay graph greedily towards `p`, which always ends at the nearest site.
+    std::optional<std::size_t> nearest_site(const point_type& p) const
+    {
+        const vertex_t v = { static_cast<double>(p[0]), static_cast<double>(p[1]) };
+        if (m_sites.empty() || !std::isfinite(v[0]) || !std::isfinite(v[1]))
+        {
+            return std::nullopt;
+        }
+
+        index_t current = npos;
+        double current_dist = std::numeric_limits<double>::max();
+        const auto closer = [&](index_t vertex)
+        {
+            if (vertex != infinite && distance_sqr(m_vertices[vertex], v) < current_dist)
+            {
+                current = vertex;
+                current_dist = distance_sqr(m_vertices[vertex], v);
+                return true;
+            }
+            return false;
+        };
+        if (m_faces.empty())
+        {
+            for (index_t vertex = 1; vertex < m_vertices.size(); ++vertex)
+            {
+                closer(vertex);
+            }
+            return static_cast<std::size_t>(current - 1);
+        }
+
+        for (const index_t vertex : m_faces[locate(v)].vertices)
+        {
+            closer(vertex);
+        }
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+            const index_t first = m_vertex_face[current];
+            index_t face_index = first;
+            do
+            {
+                const face_t& face = m_faces[face_index];
+                for (const index_t vertex : face.vertices)
+                {
+                    moved = closer(vertex) || moved;
+                }
+                face_index = face.neighbours[(position(face, current) + 1) % 3];
+            } while (!moved && face_index != first);
+        }
+        return static_cast<std::size_t>(current - 1);
+    }
+
+    // Delaunay triangles of the sites.
+    std::vector<std::array<point_type, 3>> triangles() const
+    {
+        std::vector<std::array<point_type, 3>> result;
+        result.reserve(m_faces.size());
+        for (const face_t& face : m_faces)
+        {
+            if (face.alive && !is_ghost(face))
+            {
+                result.push_back({ site(face.vertices[0]), site(face.vertices[1]), site(face.vertices[2]) });
+            }
+        }
+        return result;
+    }
+
+private:
+    using vertex_t = detail::point_t;
+
+    static constexpr index_t infinite = 0;
+
+    struct face_t
+    {
+        std::array<index_t, 3> vertices;    // counter-clockwise, with the vertex at infinity beyond the hull edge
+        std::array<index_t, 3> neighbours;  // neighbours[i] is across the edge opposite to vertices[i]
+        vertex_t circumcenter;              // of a finite face
+        bool alive;
+    };
+
+    struct boundary_edge_t
+    {
+        index_t a;
+        index_t b;
+        index_t outer;           // face on the other side of the edge
+        std::size_t outer_edge;  // index of the edge in `outer`
+    };
+
+    static bool is_ghost(const face_t& face)
+    {
+        return face.vertices[0] == infinite || face.vertices[1] == infinite || face.vertices[2] == infinite;
+    }
+
+    static std::size_t position(const face_t& face, index_t vertex)
+    {
+        return face.vertices[0] == vertex ? 0 : face.vertices[1] == vertex ? 1 : 2;
+    }
+
+    const point_type& site(index_t vertex) const
+    {
+        return m_sites[vertex - 1];
+    }
+
+    face_t make_face(index_t a, index_t b, index_t c) const
+    {
+        face_t face = {};
+        face.vertices = { a, b, c };
+        face.neighbours = { npos, npos, npos };
+        face.alive = true;
+        if (a == infinite || b == infinite || c == infinite)
+        {
+            return face;
+        }
+
+        const vertex_t& pa = m_vertices[a];
+        const vertex_t& pb = m_vertices[b];
+        const vertex_t& pc = m_vertices[c];
+
+        // Circumcenter relative to `pa` to keep the magnitudes small.
+        const double bx = pb[0] - pa[0];
+        const double by = pb[1] - pa[1];
+        const double cx = pc[0] - pa[0];
+        const double cy = pc[1] - pa[1];
+        const double d = 2.0 * (bx * cy - by * cx);
+        const double b2 = bx * bx + by * by;
+        const double c2 = cx * cx + cy * cy;
+        face.circumcenter = { pa[0] + (cy * b2 - by * c2) / d, pa[1] + (bx * c2 - cx * b2) / d };
+        return face;
+    }
+
+    // Whether `v` lies in the open circumcircle of `face`. That of a ghost face is the open half-plane beyond its hull
+    // edge, together with the open edge itself.
+    bool in_conflict(const face_t& face, const vertex_t& v) const
+    {
+        if (!is_ghost(face))
+        {
+            return detail::in_circle(
+                       m_vertices[face.vertices[0]], m_vertices[face.vertices[1]], m_vertices[face.vertices[2]], v)
+                   > 0.0;
+        }
+        const std::size_t k = position(face, infinite);
+        const vertex_t& a = m_vertices[face.vertices[(k + 1) % 3]];
+        const vertex_t& b = m_vertices[face.vertices[(k + 2) % 3]];
+        const double side = detail::orient(a, b, v);
+        if (side != 0.0)
+        {
+            return side > 0.0;
+        }
+        const std::size_t axis = a[0] != b[0] ? 0 : 1;
+        return std::min(a[axis], b[axis]) < v[axis] && v[axis] < std::max(a[axis], b[axis]);
+    }
+
+    // A finite face incident to `face`: itself, or the one across the hull edge of a ghost face.
+    index_t finite_face(index_t face) const
+    {
+        return is_ghost(m_faces[face]) ? m_faces[face].neighbours[position(m_faces[face], infinite)] : face;
+    }
+
+    // Jump-and-walk: start from the closest of ~cbrt(n) sampled sites (or the most recently created face, if closer),
+    // then walk towards `v`. Keeps point location sublinear for non-coherent insertion orders.
+    index_t start_face(const vertex_t& v) const
+    {
+        index_t best = finite_face(m_last_face);
+        double best_dist = distance_sqr(m_vertices[m_faces[best].vertices[0]], v);
+
+        const std::size_t count = m_vertices.size() - 1;
+        const auto samples = static_cast<std::size_t>(std::cbrt(static_cast<double>(count)));
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            const index_t vertex = static_cast<index_t>(1 + (i * 2654435761u + count) % count);
+            const double dist = distance_sqr(m_vertices[vertex], v);
+            if (dist < best_dist)
+            {
+                best_dist = dist;
+                best = finite_face(m_vertex_face[vertex]);
+            }
+        }
+        return best;
+    }
+
+    // Position of `p` along a Hilbert curve over the bounding box [min, max] of a batch.
+    static std::uint64_t hilbert_index(const point_type& p, const vertex_t& min, const vertex_t& max)
+    {
+        constexpr std::uint32_t n = 1u << 16;
+        const auto quantize = [&](std::size_t axis)
+        {
+            const double extent = max[axis] - min[axis];
+            const double normalized = extent > 0.0 ? (static_cast<double>(p[axis]) - min[axis]) / extent : 0.0;
+            return std::min(static_cast<std::uint32_t>(normalized * (n - 1)), n - 1);
+        };
+
+        std::uint32_t x = quantize(0);
+        std::uint32_t y = quantize(1);
+        std::uint64_t d = 0;
+        for (std::uint32_t s = n / 2; s > 0; s /= 2)
+        {
+            const std::uint32_t rx = (x & s) > 0 ? 1 : 0;
+            const std::uint32_t ry = (y & s) > 0 ? 1 : 0;
+            d += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    static double distance_sqr(const vertex_t& a, const vertex_t& b)
+    {
+        const double dx = a[0] - b[0];
+        const double dy = a[1] - b[1];
+        return dx * dx + dy * dy;
+    }
+
+    // Visibility walk towards `v` through the finite faces. Returns the finite face containing `v`, or the ghost face
+    // beyond the hull edge that the walk crossed; either way a face whose circumcircle contains `v` unless `v` is one
+    // of its vertices. With exact predicates the walk always ends in a Delaunay triangulation.
+    index_t locate(const vertex_t& v) const
+    {
+        index_t current = start_face(v);
+        for (std::size_t step = 0;; ++step)
+        {
+            const face_t& face = m_faces[current];
+            index_t next = npos;
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                // Rotate the first tested edge so that the walk does not always favour the same direction.
+                const std::size_t i = (k + step) % 3;
+                const vertex_t& a = m_vertices[face.vertices[(i + 1) % 3]];
+                const vertex_t& b = m_vertices[face.vertices[(i + 2) % 3]];
+                if (detail::orient(a, b, v) < 0.0)
+                {
+                    next = face.neighbours[i];
+                    break;
+                }
+            }
+            if (next == npos || is_ghost(m_faces[next]))
+            {
+                return next == npos ? current : next;
+            }
+            current = next;
+        }
+    }
+
+    // First sites, while they are all collinear: recorded without faces until one of them is not.
+    bool insert_collinear(const point_type& p, const vertex_t& v)
+    {
+        for (index_t vertex = 1; vertex < m_vertices.size(); ++vertex)
+        {
+            if (m_vertices[vertex] == v)
+            {
+                return false;
+            }
+        }
+        if (m_vertices.size() < 3 || detail::orient(m_vertices[1], m_vertices[2], v) == 0.0)
+        {
+            reserve_site();
+            append_site(p, v);
+            return true;
+        }
+        // Built on a copy, which only replaces this triangulation once it is complete.
+        triangulation_t built = *this;
+        built.reserve_site();
+        built.build(built.append_site(p, v));
+        *this = std::move(built);
+        return true;
+    }
+
+    // Makes room for one more site, so that `append_site` cannot fail.
+    void reserve_site()
+    {
+        const std::size_t vertex = m_vertices.size();
+        m_vertices.reserve(vertex + 1);
+        m_vertices.mutate(vertex);
+        m_vertex_face.reserve(vertex + 1);
+        m_vertex_face.mutate(vertex);
+        m_sites.reserve(vertex);
+        m_sites.mutate(vertex - 1);
+        m_cells.reserve(vertex);
+        m_cells.mutate(vertex - 1);
+    }
+
+    index_t append_site(const point_type& p, const vertex_t& v)
+    {
+        const auto vertex = static_cast<index_t>(m_vertices.size());
+        m_vertices.push_back(v);
+        m_vertex_face.push_back(npos);
+        m_sites.push_back(p);
+        m_cells.emplace_back();
+        return vertex;
+    }
+
+    // Allocates everything the insertion of the cavity's site writes: room for the new site and faces, and private
+    // copies of the chunks holding the elements that change, with room for the cells to grow.
+    void reserve_insertion()
+    {
+        reserve_site();
+        m_cells.mutate(m_sites.size()).reserve(m_scratch.boundary.size());
+
+        // New faces take the places of the cavity's, then of free ones, then go at the end, as in `fill_cavity`.
+        const std::size_t created = m_scratch.boundary.size();
+        const std::size_t reused = std::min(created, m_scratch.cavity.size());
+        const std::size_t recycled = std::min(created - reused, m_free.size());
+        const std::size_t appended = created - reused - recycled;
+        m_faces.reserve(m_faces.size() + appended);
+        for (const index_t f : m_scratch.cavity)
+        {
+            m_faces.mutate(f);
+        }
+        for (std::size_t i = 0; i < recycled; ++i)
+        {
+            m_faces.mutate(m_free[m_free.size() - 1 - i]);
+        }
+        for (std::size_t i = 0; i < appended; ++i)
+        {
+            m_faces.mutate(m_faces.size() + i);
+        }
+        for (const boundary_edge_t& edge : m_scratch.boundary)
+        {
+            m_faces.mutate(edge.outer);
+            m_vertex_face.mutate(edge.a);
+            if (edge.a != infinite)
+            {
+                polygon_type& cell = m_cells.mutate(edge.a - 1);
+                cell.reserve(cell.size() + 1);  // the star of a boundary vertex gains two faces and loses at least one
+            }
+        }
+        m_free.reserve(m_free.size() + m_scratch.cavity.size());
+        m_scratch.created.reserve(created);
+    }
+
+    // Triangulates the collinear sites as a fan from `apex`, the first site off their line. The fan is Delaunay: the
+    // circumcircle of each triangle meets the line only at the two sites of its base.
+    void build(index_t apex)
+    {
+        std::vector<index_t> chain(m_vertices.size() - 2);
+        for (std::size_t i = 0; i < chain.size(); ++i)
+        {
+            chain[i] = static_cast<index_t>(i + 1);
+        }
+        std::sort(chain.begin(), chain.end(), [this](index_t a, index_t b) { return m_vertices[a] < m_vertices[b]; });
+        if (detail::orient(m_vertices[chain.front()], m_vertices[chain.back()], m_vertices[apex]) < 0.0)
+        {
+            std::reverse(chain.begin(), chain.end());
+        }
+
+        // Counter-clockwise, the hull runs along the chain, then through the apex back to its start.
+        m_faces.reserve(2 * chain.size() + 2);
+        for (std::size_t i = 0; i + 1 < chain.size(); ++i)
+        {
+            m_faces.push_back(make_face(chain[i], chain[i + 1], apex));
+            m_faces.push_back(make_face(chain[i + 1], chain[i], infinite));
+        }
+        m_faces.push_back(make_face(apex, chain.back(), infinite));
+        m_faces.push_back(make_face(chain.front(), apex, infinite));
+
+        // Each edge is shared by the two faces that hold it in opposite directions.
+        std::vector<std::pair<std::array<index_t, 2>, std::pair<index_t, std::size_t>>> edges;
+        for (index_t f = 0; f < m_faces.size(); ++f)
+        {
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto& vertices = m_faces[f].vertices;
+                edges.push_back({ { vertices[(i + 1) % 3], vertices[(i + 2) % 3] }, { f, i } });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (const auto& [edge, side] : edges)
+        {
+            const auto twin = std::lower_bound(
+                edges.begin(),
+                edges.end(),
+                std::array<index_t, 2>{ edge[1], edge[0] },
+                [](const auto& item, const std::array<index_t, 2>& key) { return item.first < key; });
+            m_faces.mutate(side.first).neighbours[side.second] = twin->second.first;
+        }
+
+        for (index_t f = 0; f < m_faces.size(); ++f)
+        {
+            for (const index_t vertex : m_faces[f].vertices)
+            {
+                m_vertex_face.mutate(vertex) = f;
+            }
+        }
+        m_last_face = 0;
+        for (index_t vertex = 1; vertex < m_vertices.size(); ++vertex)
+        {
+            update_cell(vertex);
+        }
+    }
+
+    // Finds the faces whose circumcircles contain `v`, and the edges around them, without changing any.
+    void collect_cavity(index_t containing, const vertex_t& v)
+    {
+        m_scratch.cavity.clear();
+        m_scratch.boundary.clear();
+        m_scratch.stack.clear();
+        m_scratch.visited.resize(m_faces.size(), 0);
+        if (++m_scratch.epoch == 0)
+        {
+            std::fill(m_scratch.visited.begin(), m_scratch.visited.end(), 0);
+            m_scratch.epoch = 1;
+        }
+
+        m_scratch.cavity.push_back(containing);
+        m_scratch.stack.push_back(containing);
+        m_scratch.visited[containing] = m_scratch.epoch;
+
+        while (!m_scratch.stack.empty())
+        {
+            const index_t f = m_scratch.stack.back();
+            m_scratch.stack.pop_back();
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const face_t& face = m_faces[f];
+                const index_t n = face.neighbours[i];
+                if (m_scratch.visited[n] == m_scratch.epoch)
+                {
+                    continue;  // already in the cavity
+                }
+                if (in_conflict(m_faces[n], v))
+                {
+                    m_scratch.cavity.push_back(n);
+                    m_scratch.stack.push_back(n);
+                    m_scratch.visited[n] = m_scratch.epoch;
+                    continue;
+                }
+                std::size_t outer_edge = 0;
+                while (m_faces[n].neighbours[outer_edge] != f)
+                {
+                    ++outer_edge;
+                }
+                m_scratch.boundary.push_back(
+                    boundary_edge_t{ face.vertices[(i + 1) % 3], face.vertices[(i + 2) % 3], n, outer_edge });
+            }
+        }
+    }
+
+    void fill_cavity(index_t p)
+    {
+        m_scratch.created.clear();
+        std::size_t reused = 0;
+        for (const boundary_edge_t& edge : m_scratch.boundary)
+        {
+            index_t f = npos;
+            if (reused < m_scratch.cavity.size())
+            {
+                f = m_scratch.cavity[reused++];
+            }
+            else if (!m_free.empty())
+            {
+                f = m_free.back();
+                m_free.pop_back();
+            }
+            else
+            {
+                f = static_cast<index_t>(m_faces.size());
+                m_faces.emplace_back();
+            }
+
+            face_t& face = m_faces.mutate(f);
+            face = make_face(p, edge.a, edge.b);
+            face.neighbours[0] = edge.outer;
+            m_faces.mutate(edge.outer).neighbours[edge.outer_edge] = f;
+            m_scratch.created.push_back(f);
+        }
+        for (std::size_t i = reused; i < m_scratch.cavity.size(); ++i)
+        {
+            m_faces.mutate(m_scratch.cavity[i]).alive = false;
+            m_free.push_back(m_scratch.cavity[i]);
+        }
+
+        // Stitch the fan around `p`: face (p, a, b) borders (p, b, c) across (b, p) and (p, z, a) across (p, a).
+        for (const index_t f : m_scratch.created)
+        {
+            face_t& face = m_faces.mutate(f);
+            for (const index_t g : m_scratch.created)
+            {
+                const face_t& other = m_faces[g];
+                if (other.vertices[1] == face.vertices[2])
+                {
+                    face.neighbours[1] = g;
+                }
+                if (other.vertices[2] == face.vertices[1])
+                {
+                    face.neighbours[2] = g;
+                }
+            }
+            for (const index_t vertex : face.vertices)
+            {
+                m_vertex_face.mutate(vertex) = f;
+            }
+        }
+        m_last_face = m_scratch.created.back();
+    }
+
+    void update_cells()
+    {
+        for (const boundary_edge_t& edge : m_scratch.boundary)
+        {
+            update_cell(edge.a);
+        }
+        update_cell(static_cast<index_t>(m_vertices.size() - 1));
+    }
+
+    // Circumcenters of the faces around `vertex`. A ghost face stands for the Voronoi edge of its hull edge, which
+    // runs off to infinity from the circumcenter of the finite face on the edge; it is cut `m_far` beyond it.
+    void update_cell(index_t vertex)
+    {
+        if (vertex == infinite)
+        {
+            return;
+        }
+        polygon_type& cell = m_cells.mutate(vertex - 1);
+        cell.clear();
+
+        const index_t first = m_vertex_face[vertex];
+        index_t current = first;
+        do
+        {
+            const face_t& face = m_faces[current];
+            vertex_t corner = face.circumcenter;
+            if (is_ghost(face))
+            {
+                const std::size_t k = position(face, infinite);
+                const vertex_t& a = m_vertices[face.vertices[(k + 1) % 3]];
+                const vertex_t& b = m_vertices[face.vertices[(k + 2) % 3]];
+                const double length = std::sqrt(distance_sqr(a, b));
+                corner = m_faces[face.neighbours[k]].circumcenter;
+                corner[0] -= (b[1] - a[1]) / length * m_far;  // outward normal of the hull edge a -> b
+                corner[1] += (b[0] - a[0]) / length * m_far;
+            }
+            cell.push_back(point_type{ static_cast<T>(corner[0]), static_cast<T>(corner[1]) });
+            current = face.neighbours[(position(face, vertex) + 1) % 3];
+        } while (current != first);
+    }
+
+    // Copies of the triangulation share the chunks of the mesh and the cells that neither of them has changed since.
+    double m_far;
+    shared_chunks<vertex_t, mesh_chunk_size> m_vertices;    // the vertex at infinity, then the sites
+    shared_chunks<index_t, mesh_chunk_size> m_vertex_face;  // a face around each vertex
+    shared_chunks<face_t, mesh_chunk_size> m_faces;         // empty while all sites are collinear
+    std::vector<index_t> m_free;
+    shared_chunks<point_type, mesh_chunk_size> m_sites;
+    shared_chunks<polygon_type> m_cells;
+    index_t m_last_face = 0;
+
+    // Buffers reused across insertions. Copies of the triangulation start with empty ones.
+    struct scratch_t
+    {
+        std::vector<index_t> cavity;
+        std::vector<index_t> stack;
+        std::vector<std::uint32_t> visited;  // faces pushed to `cavity` by the insertion whose `epoch` matches
+        std::uint32_t epoch = 0;
+        std::vector<boundary_edge_t> boundary;
+        std::vector<index_t> created;
+        std::vector<std::pair<std::uint64_t, point_type>> batch;
+
+        scratch_t() = default;
+        scratch_t(const scratch_t&)
+        {
+        }
+
+        scratch_t& operator=(const scratch_t&)
+        {
+            return *this;
+        }
+    };
+    scratch_t m_scratch;
+};
+
+}  // namespace delaunay
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <zx/mat.hpp>
+
+#include "thread_pool.hpp"
+
+using duration_t = float;  // s
+
+struct Boid
+{
+    struct Linear
+    {
+        zx::mat::vector_t<float, 2> location = {};
+        zx::mat::vector_t<float, 2> velocity = {};
+        zx::mat::vector_t<float, 2> accelarion = {};
+    };
+    struct Angular
+    {
+        float location = 0.F;
+        float velocity = 0.F;
+        float acceleration = 0.F;
+    };
+
+    Linear linear;
+    Angular angular;
+
+    void update(duration_t dt, float max_angular_velocity)
+    {
+        linear.velocity += linear.accelarion * dt;
+        linear.location += linear.velocity * dt;
+
+        angular.velocity += angular.acceleration * dt;
+        angular.velocity = std::min(angular.velocity, +max_angular_velocity);
+        angular.velocity = std::max(angular.velocity, -max_angular_velocity);
+        angular.location += angular.velocity * dt;
+    }
+};
+
+// Boids steered by separation, alignment and cohesion within a rectangular world that wraps around at its edges.
+// The boids are stored as parallel arrays. Every update bins them into a uniform grid of `radius`-sized cells with a
+// counting sort, copying positions and velocities into cell order, so that the neighbours of a boid are found in the
+// 3x3 surrounding cells, read from three contiguous ranges (six at the edges, where the grid wraps around).
+// Every boid is computed from the previous state alone, and the binning is a stable sort whose order does not depend on
+// how it is split between threads, so the result is the same for any number of threads.
+class Flock
+{
+public:
+    using vec2 = zx::mat::vector_t<float, 2>;
+
+    struct Settings
+    {
+        vec2 min = { 0.F, 0.F };
+        vec2 max = { 1024.F, 768.F };
+        float radius = 25.F;  // neighbourhood for alignment and cohesion, and the size of a grid cell
+        float separation_radius = 10.F;
+        float separation_weight = 1500.F;
+        float alignment_weight = 2.F;
+        float cohesion_weight = 1.F;
+        float min_speed = 40.F;
+        float max_speed = 100.F;
+        float max_acceleration = 200.F;
+        float max_angular_velocity = 6.F;  // rad/s, for turning the heading towards the velocity
+        float turn_rate = 60.F;            // angular acceleration per radian between heading and velocity
+    };
+
+    explicit Flock(const Settings& settings) : m_settings(settings)
+    {
+        const float width = m_settings.max[0] - m_settings.min[0];
+        const float height = m_settings.max[1] - m_settings.min[1];
+        m_columns = std::max(static_cast<int>(width / m_settings.radius), 1);
+        m_rows = std::max(static_cast<int>(height / m_settings.radius), 1);
+        m_cell_width = width / static_cast<float>(m_columns);
+        m_cell_height = height / static_cast<float>(m_rows);
+        m_cell_start.assign(static_cast<std::size_t>(m_columns) * m_rows + 1, 0);
+    }
+
+    const Settings& settings() const
+    {
+        return m_settings;
+    }
+
+    std::size_t add(const Boid& boid)
+    {
+        m_locations.push_back(boid.linear.location);
+        m_previous_locations.push_back(boid.linear.location);
+        m_velocities.push_back(boid.linear.velocity);
+        m_accelerations.push_back(boid.linear.accelarion);
+        m_headings.push_back(boid.angular.location);
+        m_angular_velocities.push_back(boid.angular.velocity);
+        return m_locations.size() - 1;
+    }
+
+    std::size_t size() const
+    {
+        return m_locations.size();
+    }
+
+    Boid operator[](std::size_t i) const
+    {
+        return Boid{ Boid::Linear{ m_locations[i], m_velocities[i], m_accelerations[i] },
+                     Boid::Angular{ m_headings[i], m_angular_velocities[i], 0.F } };
+    }
+
+    const std::vector<vec2>& locations() const
+    {
+        return m_locations;
+    }
+
+    const std::vector<vec2>& velocities() const
+    {
+        return m_velocities;
+    }
+
+    const std::vector<float>& headings() const
+    {
+        return m_headings;
+    }
+
+    // Location of boid `i` a fraction `alpha` of the way from the update before the last one to the last one.
+    // Boids that wrapped around the world in the last update are not interpolated.
+    vec2 location(std::size_t i, float alpha) const
+    {
+        const vec2& from = m_previous_locations[i];
+        const vec2& to = m_locations[i];
+        const float half_width = 0.5F * (m_settings.max[0] - m_settings.min[0]);
+        const float half_height = 0.5F * (m_settings.max[1] - m_settings.min[1]);
+        if (std::abs(to[0] - from[0]) > half_width || std::abs(to[1] - from[1]) > half_height)
+        {
+            return to;
+        }
+        return vec2{ from[0] + alpha * (to[0] - from[0]), from[1] + alpha * (to[1] - from[1]) };
+    }
+
+    void update(duration_t dt)
+    {
+        ThreadPool pool{ 1 };
+        update(dt, pool);
+    }
+
+    void update(duration_t dt, ThreadPool& pool)
+    {
+        m_previous_locations = m_locations;
+        bin(pool);
+        pool.parallel_for(
+            m_cell_start.size() - 1, cell_chunk_size, [this](std::size_t begin, std::size_t end) { steer(begin, end); });
+        pool.parallel_for(
+            size(), boid_chunk_size, [this, dt](std::size_t begin, std::size_t end) { integrate(dt, begin, end); });
+    }
+
+private:
+    std::size_t cell_of(const vec2& p) const
+    {
+        const int x = std::clamp(static_cast<int>((p[0] - m_settings.min[0]) / m_cell_width), 0, m_columns - 1);
+        const int y = std::clamp(static_cast<int>((p[1] - m_settings.min[1]) / m_cell_height), 0, m_rows - 1);
+        return static_cast<std::size_t>(y) * m_columns + x;
+    }
+
+    // Counting sort by cell, stable so that boids within a cell stay in index order. Each chunk of boids counts its
+    // boids per cell; the slots of a cell are then handed out to the chunks in chunk order, and every chunk places its
+    // boids independently. There is one chunk per thread, so that the histograms stay proportional to the grid rather
+    // than to the number of boids times the grid.
+    void bin(ThreadPool& pool)
+    {
+        const std::size_t n = size();
+        const std::size_t cells = m_cell_start.size() - 1;
+        const std::size_t chunks = std::max(std::min(pool.size(), n / boid_chunk_size), std::size_t{ 1 });
+        const std::size_t chunk_size = (n + chunks - 1) / chunks;
+        m_cells.resize(n);
+        m_offsets.assign(chunks * cells, 0);
+        pool.parallel_for(
+            n,
+            chunk_size,
+            [&](std::size_t begin, std::size_t end)
+            {
+                std::uint32_t* counts = m_offsets.data() + begin / chunk_size * cells;
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    m_cells[i] = static_cast<std::uint32_t>(cell_of(m_locations[i]));
+                    ++counts[m_cells[i]];
+                }
+            });
+
+        std::uint32_t slot = 0;
+        for (std::size_t cell = 0; cell < cells; ++cell)
+        {
+            m_cell_start[cell] = slot;
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                slot += std::exchange(m_offsets[chunk * cells + cell], slot);
+            }
+        }
+        m_cell_start[cells] = slot;
+
+        m_order.resize(n);
+        m_x.resize(n);
+        m_y.resize(n);
+        m_vx.resize(n);
+        m_vy.resize(n);
+        pool.parallel_for(
+            n,
+            chunk_size,
+            [&](std::size_t begin, std::size_t end)
+            {
+                std::uint32_t* next = m_offsets.data() + begin / chunk_size * cells;
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    m_order[next[m_cells[i]]++] = static_cast<std::uint32_t>(i);
+                }
+            });
+        pool.parallel_for(n, boid_chunk_size, [this](std::size_t begin, std::size_t end) { gather(begin, end); });
+    }
+
+    // Copies the state of the boids in slots [first, last) of the cell order.
+    void gather(std::size_t first, std::size_t last)
+    {
+        for (std::size_t s = first; s < last; ++s)
+        {
+            const std::uint32_t i = m_order[s];
+            m_x[s] = m_locations[i][0];
+            m_y[s] = m_locations[i][1];
+            m_vx[s] = m_velocities[i][0];
+            m_vy[s] = m_velocities[i][1];
+        }
+    }
+
+    // Columns or rows [first, last] of the grid, and the offset that moves their boids next to the cell they surround.
+    struct span
+    {
+        int first;
+        int last;
+        float offset;
+    };
+
+    // The one or two spans covering index `i` and its neighbours among `count`, wrapped around a world of `size`.
+    // Grids of fewer than 3 columns or rows are not wrapped: every boid is a neighbour along that axis.
+    static int spans_around(int i, int count, float size, std::array<span, 2>& out)
+    {
+        if (count < 3)
+        {
+            out[0] = span{ 0, count - 1, 0.F };
+            return 1;
+        }
+        if (i == 0)
+        {
+            out[0] = span{ 0, 1, 0.F };
+            out[1] = span{ count - 1, count - 1, -size };
+            return 2;
+        }
+        if (i == count - 1)
+        {
+            out[0] = span{ count - 2, count - 1, 0.F };
+            out[1] = span{ 0, 0, size };
+            return 2;
+        }
+        out[0] = span{ i - 1, i + 1, 0.F };
+        return 1;
+    }
+
+    // Computes the accelerations of the boids in cells [first, last).
+    void steer(std::size_t first, std::size_t last)
+    {
+        const Settings& s = m_settings;
+        const float width = s.max[0] - s.min[0];
+        const float height = s.max[1] - s.min[1];
+        for (std::size_t cell = first; cell < last; ++cell)
+        {
+            std::array<span, 2> columns;
+            std::array<span, 2> rows;
+            const int column_count = spans_around(static_cast<int>(cell % m_columns), m_columns, width, columns);
+            const int row_count = spans_around(static_cast<int>(cell / m_columns), m_rows, height, rows);
+            for (std::uint32_t slot = m_cell_start[cell]; slot < m_cell_start[cell + 1]; ++slot)
+            {
+                sums total = {};
+                for (int r = 0; r < row_count; ++r)
+                {
+                    for (int y = rows[r].first; y <= rows[r].last; ++y)
+                    {
+                        const std::size_t row = static_cast<std::size_t>(y) * m_columns;
+                        for (int c = 0; c < column_count; ++c)
+                        {
+                            // Neighbours across the edges are compared with the boid moved to their side of the world.
+                            const span& x = columns[c];
+                            sums part = neighbours(m_x[slot] - x.offset,
+                                                   m_y[slot] - rows[r].offset,
+                                                   m_cell_start[row + x.first],
+                                                   m_cell_start[row + x.last + 1]);
+                            part.x += part.count * x.offset;
+                            part.y += part.count * rows[r].offset;
+                            total += part;
+                        }
+                    }
+                }
+
+                // The boid itself is among its neighbours, at distance 0.
+                const float count = total.count - 1.F;
+                float ax = s.separation_weight * total.sep_x;
+                float ay = s.separation_weight * total.sep_y;
+                if (count > 0.F)
+                {
+                    const float inv = 1.F / count;
+                    ax += s.alignment_weight * ((total.vx - m_vx[slot]) * inv - m_vx[slot])
+                          + s.cohesion_weight * ((total.x - m_x[slot]) * inv - m_x[slot]);
+                    ay += s.alignment_weight * ((total.vy - m_vy[slot]) * inv - m_vy[slot])
+                          + s.cohesion_weight * ((total.y - m_y[slot]) * inv - m_y[slot]);
+                }
+                const float a2 = ax * ax + ay * ay;
+                if (a2 > s.max_acceleration * s.max_acceleration)
+                {
+                    const float scale = s.max_acceleration / std::sqrt(a2);
+                    ax *= scale;
+                    ay *= scale;
+                }
+                m_accelerations[m_order[slot]] = vec2{ ax, ay };
+            }
+        }
+    }
+
+    struct sums
+    {
+        float count = 0.F;
+        float x = 0.F;
+        float y = 0.F;
+        float vx = 0.F;
+        float vy = 0.F;
+        float sep_x = 0.F;
+        float sep_y = 0.F;
+
+        sums& operator+=(const sums& other)
+        {
+            count += other.count;
+            x += other.x;
+            y += other.y;
+            vx += other.vx;
+            vy += other.vy;
+            sep_x += other.sep_x;
+            sep_y += other.sep_y;
+            return *this;
+        }
+    };
+
+    // Accumulates the boids in slots [first, last) within `radius` of (px, py), the boid itself included.
+    // Branch-free: with about 20 candidates per boid, a mispredicted branch costs more than the masked arithmetic.
+    sums neighbours(float px, float py, std::uint32_t first, std::uint32_t last) const
+    {
+        const float radius_sqr = m_settings.radius * m_settings.radius;
+        const float separation_sqr = m_settings.separation_radius * m_settings.separation_radius;
+        sums result = {};
+        for (std::uint32_t k = first; k < last; ++k)
+        {
+            const float dx = px - m_x[k];
+            const float dy = py - m_y[k];
+            const float d2 = dx * dx + dy * dy;
+            const float in = d2 < radius_sqr ? 1.F : 0.F;
+            const float push = d2 < separation_sqr && d2 > 0.F ? 1.F / d2 : 0.F;
+            result.count += in;
+            result.x += in * m_x[k];
+            result.y += in * m_y[k];
+            result.vx += in * m_vx[k];
+            result.vy += in * m_vy[k];
+            result.sep_x += push * dx;
+            result.sep_y += push * dy;
+        }
+        return result;
+    }
+
+    // Approximation of `std::atan2(y, x)` within 2e-4 rad, several times faster than the library function.
+    static float direction_of(float x, float y)
+    {
+        constexpr float pi = 3.14159265F;
+        const float ax = std::abs(x);
+        const float ay = std::abs(y);
+        const float max = std::max(ax, ay);
+        const float a = max > 0.F ? std::min(ax, ay) / max : 0.F;
+        const float s = a * a;
+        float r = ((-0.0464964749F * s + 0.15931422F) * s - 0.327622764F) * s * a + a;
+        r = ay > ax ? 0.5F * pi - r : r;
+        r = x < 0.F ? pi - r : r;
+        return y < 0.F ? -r : r;
+    }
+
+    // Advances boids [first, last) through `Boid::update`, then keeps their speed within limits and wraps them into the
+    // world. The heading turns towards the direction of the velocity.
+    void integrate(duration_t dt, std::size_t first, std::size_t last)
+    {
+        constexpr float pi = 3.14159265F;
+        const Settings& s = m_settings;
+        const float width = s.max[0] - s.min[0];
+        const float height = s.max[1] - s.min[1];
+        const float damping = 2.F * std::sqrt(s.turn_rate);
+        const auto wrap = [](float value, float min, float size)
+        { return value < min ? value + size : value >= min + size ? value - size : value; };
+        for (std::size_t i = first; i < last; ++i)
+        {
+            Boid boid = (*this)[i];
+            const vec2& v = boid.linear.velocity;
+            const float turn = wrap(direction_of(v[0], v[1]) - boid.angular.location, -pi, 2.F * pi);
+            boid.angular.acceleration = s.turn_rate * turn - damping * boid.angular.velocity;
+            boid.update(dt, s.max_angular_velocity);
+
+            vec2& velocity = boid.linear.velocity;
+            const float speed = std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1]);
+            if (speed > s.max_speed)
+            {
+                velocity = velocity * (s.max_speed / speed);
+            }
+            else if (speed < s.min_speed)
+            {
+                // Keeps moving along the heading when the velocity vanishes.
+                velocity = speed > 0.F ? velocity * (s.min_speed / speed)
+                                       : vec2{ std::cos(boid.angular.location), std::sin(boid.angular.location) }
+                                             * s.min_speed;
+            }
+            const vec2& p = boid.linear.location;
+            m_locations[i] = vec2{ wrap(p[0], s.min[0], width), wrap(p[1], s.min[1], height) };
+            m_velocities[i] = velocity;
+            m_headings[i] = wrap(boid.angular.location, -pi, 2.F * pi);
+            m_angular_velocities[i] = boid.angular.velocity;
+        }
+    }
+
+    static constexpr std::size_t boid_chunk_size = 1024;
+    static constexpr std::size_t cell_chunk_size = 32;
+
+    Settings m_settings;
+    int m_columns = 1;
+    int m_rows = 1;
+    float m_cell_width = 1.F;
+    float m_cell_height = 1.F;
+
+    std::vector<vec2> m_locations = {};
+    std::vector<vec2> m_previous_locations = {};  // as of the start of the last update
+    std::vector<vec2> m_velocities = {};
+    std::vector<vec2> m_accelerations = {};
+    std::vector<float> m_headings = {};
+    std::vector<float> m_angular_velocities = {};
+
+    // Grid, rebuilt by every update.
+    std::vector<std::uint32_t> m_cells = {};       // cell of each boid
+    std::vector<std::uint32_t> m_cell_start = {};  // first slot of each cell in `m_order`, plus the total count
+    std::vector<std::uint32_t> m_offsets = {};     // per binning chunk and cell, the next slot of the chunk
+    std::vector<std::uint32_t> m_order = {};  // boid in each slot
+    std::vector<float> m_x = {};              // state of the boid in each slot
+    std::vector<float> m_y = {};
+    std::vector<float> m_vx = {};
+    std::vector<float> m_vy = {};
+};
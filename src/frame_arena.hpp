@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Monotonic arena for allocations that only live until the end of a frame.
+// Reset after each frame; when a frame outgrows the buffer it is enlarged to the high-water mark, so in steady state
+// no allocation reaches the global heap.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    struct Stats
+    {
+        std::size_t bytes = 0;
+        std::size_t allocations = 0;
+        std::size_t upstream_allocations = 0;  // allocations that did not fit into the buffer
+    };
+
+    explicit FrameArena(std::size_t capacity = std::size_t{ 1 } << 20)
+    {
+        reserve(capacity);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Releases everything allocated during the frame and records its statistics.
+    void reset()
+    {
+        m_last_frame = m_current;
+        m_current = Stats{};
+        ++m_frames;
+        if (m_last_frame.upstream_allocations > 0)
+        {
+            ++m_overflowed_frames;
+            reserve(2 * m_last_frame.bytes);
+        }
+        else
+        {
+            m_resource->release();
+        }
+    }
+
+    const Stats& last_frame() const
+    {
+        return m_last_frame;
+    }
+
+    std::size_t frames() const
+    {
+        return m_frames;
+    }
+
+    // Frames that reached the global heap because they outgrew the buffer.
+    std::size_t overflowed_frames() const
+    {
+        return m_overflowed_frames;
+    }
+
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    void reserve(std::size_t capacity)
+    {
+        m_resource.reset();
+        m_buffer = std::make_unique<std::byte[]>(capacity);
+        m_capacity = capacity;
+        m_resource.emplace(m_buffer.get(), m_capacity, &m_upstream);
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++m_current.allocations;
+        m_current.bytes += bytes;
+        return m_resource->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override
+    {
+        // monotonic: memory is reclaimed by `reset`
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    // Counts the allocations the monotonic resource forwards beyond the buffer.
+    class Upstream : public std::pmr::memory_resource
+    {
+    public:
+        explicit Upstream(Stats& stats) : m_stats(stats)
+        {
+        }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++m_stats.upstream_allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        Stats& m_stats;
+    };
+
+    Stats m_current = {};
+    Stats m_last_frame = {};
+    std::size_t m_frames = 0;
+    std::size_t m_overflowed_frames = 0;
+    Upstream m_upstream{ m_current };
+    std::unique_ptr<std::byte[]> m_buffer = {};
+    std::size_t m_capacity = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> m_resource = {};
+};
+
+inline std::pmr::memory_resource*& current_frame_resource()
+{
+    thread_local std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+    return resource;
+}
+
+// Memory resource used by per-frame containers; the global heap unless a `FrameResourceScope` is active.
+inline std::pmr::memory_resource* frame_resource()
+{
+    return current_frame_resource();
+}
+
+// Makes `resource` the frame resource of the calling thread for the lifetime of the scope.
+class FrameResourceScope
+{
+public:
+    explicit FrameResourceScope(std::pmr::memory_resource* resource) : m_previous(current_frame_resource())
+    {
+        current_frame_resource() = resource;
+    }
+
+    FrameResourceScope(const FrameResourceScope&) = delete;
+    FrameResourceScope& operator=(const FrameResourceScope&) = delete;
+
+    ~FrameResourceScope()
+    {
+        current_frame_resource() = m_previous;
+    }
+
+private:
+    std::pmr::memory_resource* m_previous;
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <zx/dcel.hpp>
+#include <zx/triangulation.hpp>
+
+#include "delaunay.hpp"
+
+enum class GeometryMode
+{
+    rebuild,      // full triangulation and voronoi of all points on every update
+    incremental,  // each point inserted into `triangulation`, only affected voronoi cells recomputed
+};
+
+// Immutable result of a geometry update, shared between the worker and the model.
+struct DcelGeometry
+{
+    std::uint64_t generation = 0;
+    std::optional<zx::geometry::dcel_t<float>> dcel = {};
+    std::optional<zx::geometry::dcel_t<float>> voronoi = {};
+    delaunay::triangulation_t<float> triangulation = {};
+    std::size_t rejected = 0;  // points left out of `triangulation` so far: duplicates and non-finite points
+};
+
+// Computes `DcelGeometry` on a background thread.
+// Jobs submitted while the worker is busy are merged, so only the newest generation is ever computed and published.
+class GeometryWorker
+{
+public:
+    explicit GeometryWorker(GeometryMode mode) : m_mode(mode), m_thread([this] { run(); })
+    {
+    }
+
+    GeometryWorker(const GeometryWorker&) = delete;
+    GeometryWorker& operator=(const GeometryWorker&) = delete;
+
+    ~GeometryWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    // In rebuild mode `points` is a snapshot of the whole point set; in incremental mode it holds only the new points.
+    void submit(std::uint64_t generation, std::vector<zx::mat::vector_t<float, 2>> points)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (m_mode == GeometryMode::incremental)
+            {
+                m_job_points.insert(m_job_points.end(), points.begin(), points.end());
+            }
+            else
+            {
+                m_job_points = std::move(points);
+            }
+            m_job_generation = generation;
+            m_has_job = true;
+        }
+        m_cv.notify_one();
+    }
+
+    GeometryMode mode() const
+    {
+        return m_mode;
+    }
+
+    // Returns the most recent result not yet taken, if any.
+    std::shared_ptr<const DcelGeometry> take()
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return std::move(m_result);
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            std::uint64_t generation = 0;
+            std::vector<zx::mat::vector_t<float, 2>> points;
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_cv.wait(lock, [this] { return m_stop || m_has_job; });
+                if (m_stop)
+                {
+                    return;
+                }
+                generation = m_job_generation;
+                points = std::move(m_job_points);
+                m_job_points.clear();
+                m_has_job = false;
+            }
+
+            auto result = compute(generation, points);
+
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (!m_result || m_result->generation < result->generation)
+            {
+                m_result = std::move(result);
+            }
+        }
+    }
+
+    std::shared_ptr<const DcelGeometry> compute(
+        std::uint64_t generation, const std::vector<zx::mat::vector_t<float, 2>>& points)
+    {
+        auto result = std::make_shared<DcelGeometry>();
+        result->generation = generation;
+        if (m_mode == GeometryMode::incremental)
+        {
+            // One site at a time, so that a site that fails to insert (leaving the triangulation as it was) is the only
+            // one left out.
+            for (const auto& p : points)
+            {
+                try
+                {
+                    m_rejected += m_triangulation.insert(p) ? 0 : 1;
+                }
+                catch (const std::exception&)
+                {
+                    ++m_rejected;
+                }
+            }
+            result->triangulation = m_triangulation;  // shares the chunks of the mesh and the cells that did not change
+            result->rejected = m_rejected;
+            return result;
+        }
+
+        try
+        {
+            result->dcel = zx::geometry::triangulate(points);
+        }
+        catch (const std::exception& e)
+        {
+            // std::cout << "error on triangulation: " << e.what() << '\n';
+            result->dcel = std::nullopt;
+        }
+        if (result->dcel)
+        {
+            try
+            {
+                result->voronoi = zx::geometry::voronoi(*result->dcel);
+            }
+            catch (const std::exception& e)
+            {
+                result->voronoi = std::nullopt;
+            }
+        }
+        return result;
+    }
+
+    GeometryMode m_mode;
+    delaunay::triangulation_t<float> m_triangulation = {};  // owned by the worker thread
+    std::size_t m_rejected = 0;                              // owned by the worker thread
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    bool m_has_job = false;
+    std::uint64_t m_job_generation = 0;
+    std::vector<zx::mat::vector_t<float, 2>> m_job_points;
+    std::shared_ptr<const DcelGeometry> m_result;
+
+    std::thread m_thread;  // last, so that it starts after all other members are initialized
+};
@@ -1,11 +1,13 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <sstream>
 #include <variant>
 #include <zx/dcel.hpp>
@@ -38,15 +40,20 @@ inline auto load_font(const std::string& path) -> sf::Font
     return result;
 }
 
+// `stats` receives the drawn and culled primitive counts of each frame.
 template <class Model>
-auto render_model(const sf::Font& font, const std::function<canvas::DrawOp(const Model&, fps_t)>& func) -> RendererFn<Model>
+auto render_model(
+    const sf::Font& font,
+    const std::function<canvas::DrawOp(const Model&, fps_t, float)>& func,
+    std::shared_ptr<canvas::Context::Stats> stats) -> RendererFn<Model>
 {
-    return [=](sf::RenderWindow& window, const Model& m, fps_t fps)
+    return [=](sf::RenderWindow& window, const Model& m, fps_t fps, float alpha)
     {
         auto ctx = canvas::Context{ window };
         const auto state = canvas::State{ canvas::Style{}, canvas::TextStyle{ font }, sf::RenderStates{} };
-        const auto scene = func(m, fps);
+        const auto scene = func(m, fps, alpha);
         scene(ctx, state);
+        *stats = ctx.stats;
     };
 }
 
@@ -55,27 +62,54 @@ inline auto get_center(sf::Vector2u desktop_size, sf::Vector2u window_size) -> s
     return { (int)(desktop_size.x / 2 - window_size.x / 2), (int)(desktop_size.y / 2 - window_size.y / 2) };
 }
 
-inline auto create_model() -> Model
+inline auto create_model(std::size_t boid_count) -> Model
 {
     Model model = {};
-    model.points_model.points = {
-        { 50.F, anim::ping_pong(anim::gradual(0.F, 500.F, anim::duration_t{ 1.F }, anim::ease::none), 10.0F) },
-        { 100.F, anim::ping_pong(anim::gradual(0.F, 500.F, anim::duration_t{ 1.F }, anim::ease::quad_in_out), 10.0F) },
-        { 150.F, anim::ping_pong(anim::gradual(0.F, 500.F, anim::duration_t{ 1.F }, anim::ease::quad_in), 10.0F) },
-        { 200.F, anim::ping_pong(anim::gradual(0.F, 500.F, anim::duration_t{ 1.F }, anim::ease::quad_out), 10.0F) },
+    const auto track = [](float y, auto ease) -> anim::store<zx::mat::vector_t<float, 2>>::track
+    {
+        return { { 0.F, y }, { 500.F, y }, anim::duration_t{ 1.F }, 0.F, anim::ease::detail::id_of(ease),
+                 anim::playback::ping_pong };
     };
+    model.points_model.add_point(track(50.F, anim::ease::none));
+    model.points_model.add_point(track(100.F, anim::ease::quad_in_out));
+    model.points_model.add_point(track(150.F, anim::ease::quad_in));
+    model.points_model.add_point(track(200.F, anim::ease::quad_out));
+    // A row of points on one shared tree, each a little ahead of the previous one.
+    const auto wave = anim::ping_pong(
+        anim::gradual(zx::mat::vector_t<float, 2>{ 0.F, 250.F },
+                      zx::mat::vector_t<float, 2>{ 500.F, 250.F },
+                      anim::duration_t{ 1.F },
+                      anim::ease::sine_in_out),
+        2.F);
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        model.points_model.add_point(wave, 0.05F * static_cast<float>(i));
+    }
+
+    std::mt19937 rng{ 1 };
+    const Flock::Settings& world = model.flock.settings();
+    std::uniform_real_distribution<float> x{ world.min[0], world.max[0] };
+    std::uniform_real_distribution<float> y{ world.min[1], world.max[1] };
+    std::uniform_real_distribution<float> v{ -world.max_speed, world.max_speed };
+    for (std::size_t i = 0; i < boid_count; ++i)
+    {
+        model.flock.add(Boid{ Boid::Linear{ { x(rng), y(rng) }, { v(rng), v(rng) } }, {} });
+    }
     return model;
 }
 
-inline auto create_app(sf::RenderWindow& window, Model model) -> App<Model, Command>
+using ModelApp = App<Model, Command, ModelSnapshot>;
+
+inline auto create_app(sf::RenderWindow& window, Model model) -> ModelApp
 {
-    auto app = App<Model, Command>{ window, std::move(model) };
+    auto app = ModelApp{ window, std::move(model) };
     app.frame_duration = duration_t{ 0.01F };
-    app.on_msg = [](sf::RenderWindow& w, const Command& cmd)
+    app.snapshot = [](ModelSnapshot& snapshot, const Model& m) { snapshot.assign(m); };
+    app.on_msg = [](ModelApp& a, const Command& cmd)
     {
         if (const auto c = std::get_if<Commands::Exit>(&cmd))
         {
-            w.close();
+            a.close();
         }
     };
 
@@ -89,8 +123,15 @@ inline auto create_app(sf::RenderWindow& window, Model model) -> App<Model, Comm
         }
         else if (const auto c = std::get_if<Commands::AddPoint>(&cmd))
         {
-            m.dcel_model.points.push_back(c->pos);
-            m.dcel_model.update();
+            m.dcel_model.add_point(c->pos);
+            return {};
+        }
+        else if (const auto c = std::get_if<Commands::AddPoints>(&cmd))
+        {
+            for (const auto& p : c->points)
+            {
+                m.dcel_model.add_point(p);
+            }
             return {};
         }
         else if (const auto c = std::get_if<Commands::Init>(&cmd))
@@ -106,10 +147,11 @@ inline auto create_app(sf::RenderWindow& window, Model model) -> App<Model, Comm
         [](Model& m, const TickEvent& event) -> std::optional<Command>
         {
             m.points_model.time_point += event.elapsed;
-            for (auto& point : m.points_model.points)
-            {
-                point.pos = zx::mat::vector_t<float, 2>{ point.animation(m.points_model.time_point), point.y };
-            }
+            m.points_model.update(*m.pool);
+            m.flock.update(event.elapsed, *m.pool);
+            // The commands of this frame's events have been handled before its ticks, so their insertions coalesce
+            // into one rebuild.
+            m.dcel_model.flush();
             return {};
         });
     app.subscribe<sf::Event::KeyPressed>(
@@ -121,6 +163,12 @@ inline auto create_app(sf::RenderWindow& window, Model model) -> App<Model, Comm
             }
             return {};
         });
+    app.subscribe<sf::Event::MouseMoved>(
+        [](Model& m, const sf::Event::MouseMoved& e) -> std::optional<Command>
+        {
+            m.dcel_model.cursor = convert_as<float>(e.position);
+            return {};
+        });
     app.subscribe<sf::Event::MouseButtonPressed>(
         [](Model& m, const sf::Event::MouseButtonPressed& e) -> std::optional<Command>
         {
@@ -143,9 +191,32 @@ void run(const std::vector<std::string_view> args)
 
     const sf::Font font = load_font(fonts_dir + "arial.ttf");
 
-    auto app = create_app(window, create_model());
-    app.render = render_model<Model>(font, Render{});
+    const auto has_flag = [&](std::string_view flag) { return std::find(args.begin(), args.end(), flag) != args.end(); };
+
+    auto app = create_app(window, create_model(has_flag("--boids") ? 2000 : 0));
+    const auto render_stats = std::make_shared<canvas::Context::Stats>();
+    app.render = render_model<ModelSnapshot>(font, Render{}, render_stats);
+    app.threaded = has_flag("--threaded");
     app.run();
+
+    const auto print_metrics = [](std::string_view name, const FrameMetrics& metrics)
+    {
+        std::cout << name << ": " << metrics.count() << " frames, average " << metrics.average() * 1000.F << " ms, max "
+                  << metrics.max() * 1000.F << " ms\n";
+    };
+    print_metrics("simulation", *app.simulation_metrics);
+    print_metrics("render", *app.render_metrics);
+    const FrameArena& arena = *app.frame_arena;
+    std::cout << "frame arena: " << arena.last_frame().bytes << " bytes in " << arena.last_frame().allocations
+              << " allocations last frame, " << arena.overflowed_frames() << " of " << arena.frames()
+              << " frames reached the heap, capacity " << arena.capacity() << " bytes\n";
+    const DcelModel& dcel = app.m_model_state.dcel_model;
+    std::cout << "geometry: " << dcel.rebuild_count << " rebuilds over " << app.m_ticks << " ticks, at most "
+              << dcel.max_rebuilds_per_flush << " per tick, " << dcel.geometry->rejected << " points rejected\n";
+    const auto& animations = app.m_model_state.points_model.animations.statistics();
+    std::cout << "animations: " << animations.requests << " instances of " << animations.unique << " shared trees, "
+              << animations.bytes << " bytes interned\n";
+    std::cout << "last frame: " << render_stats->drawn << " primitives drawn, " << render_stats->culled << " culled\n";
 }
 
 int main(int argc, char* argv[])
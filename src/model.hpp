@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <variant>
 #include <vector>
 #include <zx/dcel.hpp>
@@ -8,85 +11,124 @@
 #include <zx/triangulation.hpp>
 
 #include "animation.hpp"
+#include "animation_cache.hpp"
+#include "animation_store.hpp"
+#include "animation_types.hpp"
+#include "flock.hpp"
+#include "geometry.hpp"
+#include "spatial_index.hpp"
+#include "thread_pool.hpp"
 
-struct Boid
+struct DcelModel
 {
-    struct Linear
-    {
-        zx::mat::vector_t<float, 2> location = {};
-        zx::mat::vector_t<float, 2> velocity = {};
-        zx::mat::vector_t<float, 2> accelarion = {};
-    };
-    struct Angular
-    {
-        float location = 0.F;
-        float velocity = 0.F;
-        float acceleration = 0.F;
-    };
+    using Mode = GeometryMode;
 
-    Linear linear;
-    Angular angular;
+    Mode mode = Mode::incremental;
+    std::vector<zx::mat::vector_t<float, 2>> points = {};
+    PointIndex index = {};  // same order as `points`
+    std::optional<zx::mat::vector_t<float, 2>> cursor = {};
 
-    void update(duration_t dt, float max_angular_velocity)
-    {
-        linear.velocity += linear.accelarion * dt;
-        linear.location += linear.velocity * dt;
+    // Front buffer: the latest geometry published by the worker. Rendering keeps using it until a newer one arrives.
+    std::shared_ptr<const DcelGeometry> geometry = std::make_shared<const DcelGeometry>();
+    std::shared_ptr<GeometryWorker> worker = {};
 
-        angular.velocity += angular.acceleration * dt;
-        angular.velocity = std::min(angular.velocity, +max_angular_velocity);
-        angular.velocity = std::max(angular.velocity, -max_angular_velocity);
-        angular.location += angular.velocity * dt;
-    }
-};
+    std::vector<zx::mat::vector_t<float, 2>> pending = {};
+    bool dirty = false;
+    std::uint64_t generation = 0;
+    std::size_t rebuild_count = 0;
+    std::size_t max_rebuilds_per_flush = 0;
 
-struct DcelModel
-{
-    std::vector<zx::mat::vector_t<float, 2>> points = {};
-    std::optional<zx::geometry::dcel_t<float>> dcel = {};
-    std::optional<zx::geometry::dcel_t<float>> voronoi = {};
+    // Queues a point; the geometry is brought up to date by the next `flush()`.
+    void add_point(const zx::mat::vector_t<float, 2>& p)
+    {
+        points.push_back(p);
+        index.insert(p);
+        pending.push_back(p);
+        dirty = true;
+    }
 
-    void update()
+    // Submits all points queued since the previous flush to the worker as a single rebuild (or a single incremental
+    // batch), and swaps in the newest finished geometry. Called once per fixed-step tick.
+    // A change of `mode` takes effect here: the worker is replaced by one in the new mode, which starts from all points.
+    void flush()
     {
-        try
+        std::size_t rebuilds = 0;
+        if (worker && worker->mode() != mode)
         {
-            dcel = zx::geometry::triangulate(points);
+            worker.reset();
+            pending = points;
+            dirty = !points.empty();
         }
-        catch (const std::exception& e)
+        if (dirty)
         {
-            // std::cout << "error on triangulation: " << e.what() << '\n';
-            dcel = std::nullopt;
-        }
-        if (dcel)
-        {
-            try
+            if (!worker)
             {
-                voronoi = zx::geometry::voronoi(*dcel);
+                worker = std::make_shared<GeometryWorker>(mode);
             }
-            catch (const std::exception& e)
+            worker->submit(++generation, mode == Mode::rebuild ? points : pending);
+            pending.clear();
+            dirty = false;
+            ++rebuild_count;
+            ++rebuilds;
+        }
+        max_rebuilds_per_flush = std::max(max_rebuilds_per_flush, rebuilds);
+        if (worker)
+        {
+            // Results older than the displayed geometry are stale and dropped.
+            if (auto result = worker->take(); result && result->generation > geometry->generation)
             {
-                voronoi = std::nullopt;
+                geometry = std::move(result);
             }
         }
     }
 };
 
+// Points moving along animated tracks. `positions` animates whole 2D positions in bulk and is refreshed every tick.
+// Points following arbitrary animation trees are `instances` of the trees interned in `animations`, so that points moving
+// alike share one tree and keep only their phase and amplitude; their positions are refreshed into `instance_positions`.
 struct PointsModel
 {
-    struct Point
-    {
-        float y;
-        anim::animation<float> animation = anim::constant(0.F, 100.F);
-        zx::mat::vector_t<float, 2> pos = {};
-    };
+    using vec2 = zx::mat::vector_t<float, 2>;
 
-    std::vector<Point> points = {};
+    anim::store<vec2> positions = {};
+    anim::cache<vec2> animations = {};
+    std::vector<anim::instance<vec2>> instances = {};
+    std::vector<vec2> instance_positions = {};  // same order as `instances`
     anim::time_point_t time_point = {};
+
+    void add_point(const anim::store<vec2>::track& track)
+    {
+        positions.add(track);
+    }
+
+    void add_point(const anim::animation<vec2>& animation, anim::time_point_t phase = 0.F, float amplitude = 1.F)
+    {
+        instances.push_back(animations.instantiate(animation, phase, amplitude));
+        instance_positions.push_back(instances.back()(time_point));
+    }
+
+    void update(ThreadPool& pool)
+    {
+        positions.update(time_point, pool);
+        pool.parallel_for(
+            instances.size(),
+            4096,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    instance_positions[i] = instances[i](time_point);
+                }
+            });
+    }
 };
 
 struct Model
 {
     DcelModel dcel_model = {};
     PointsModel points_model = {};
+    Flock flock = Flock{ Flock::Settings{} };
+    std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>();  // for the per-tick updates
 };
 
 namespace Commands
@@ -102,10 +144,15 @@ struct AddPoint
 {
     zx::mat::vector_t<float, 2> pos;
 };
+struct AddPoints
+{
+    std::vector<zx::mat::vector_t<float, 2>> points;
+};
 
 }  // namespace Commands
 
 using Command = std::variant<  //
     Commands::Init,
     Commands::Exit,
-    Commands::AddPoint>;
+    Commands::AddPoint,
+    Commands::AddPoints>;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// Bounded lock-free queue for any number of producer threads and a single consumer thread.
+// Each slot of the ring carries a sequence number telling whose turn it is: a producer claims a position by advancing
+// the shared tail, moves its value in and publishes the slot by bumping its sequence; the consumer takes values in
+// position order and hands the slot back to the producers of the next lap. A producer that has claimed a position
+// but not yet published it holds up the consumer, never the other producers.
+template <class T>
+class MpscQueue
+{
+public:
+    // `capacity` is rounded up to a power of two.
+    explicit MpscQueue(std::size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument{ "MpscQueue capacity must be positive" };
+        }
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        m_mask = size - 1;
+        m_slots = std::make_unique<slot[]>(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue()
+    {
+        while (try_pop())
+        {
+        }
+    }
+
+    std::size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    // Any thread. Moves from `value` and returns true if there was room, or leaves it untouched and returns false.
+    bool try_push(T&& value)
+    {
+        std::size_t position = m_tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot& s = m_slots[position & m_mask];
+            const auto lag = static_cast<std::ptrdiff_t>(s.sequence.load(std::memory_order_acquire) - position);
+            if (lag == 0)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    ::new (static_cast<void*>(s.storage)) T(std::move(value));
+                    s.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;  // the slot still holds the value of the previous lap
+            }
+            else
+            {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only.
+    std::optional<T> try_pop()
+    {
+        slot& s = m_slots[m_head & m_mask];
+        if (s.sequence.load(std::memory_order_acquire) != m_head + 1)
+        {
+            return {};
+        }
+        T* value = std::launder(reinterpret_cast<T*>(s.storage));
+        std::optional<T> result{ std::move(*value) };
+        value->~T();
+        s.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+        ++m_head;
+        return result;
+    }
+
+private:
+    static constexpr std::size_t cache_line = 64;
+
+    struct slot
+    {
+        std::atomic<std::size_t> sequence{ 0 };
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::unique_ptr<slot[]> m_slots;
+    std::size_t m_mask = 0;
+    alignas(cache_line) std::atomic<std::size_t> m_tail{ 0 };  // next position to push, shared by the producers
+    alignas(cache_line) std::size_t m_head = 0;                // next position to pop, owned by the consumer
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+#include <zx/mat.hpp>
+
+// Uniform grid over a growing set of points, for nearest-neighbour, radius and rectangle queries.
+// The grid covers the bounding box of the points and is rebuilt (amortized O(1) per insertion) whenever a point falls
+// outside of it or the average cell occupancy exceeds `max_load`.
+class PointIndex
+{
+public:
+    using point_type = zx::mat::vector_t<float, 2>;
+    using index_t = std::uint32_t;
+
+    static constexpr float max_load = 4.F;
+
+    std::size_t insert(const point_type& p)
+    {
+        const auto index = static_cast<index_t>(m_points.size());
+        m_points.push_back(p);
+        if (!contains(p) || static_cast<float>(m_points.size()) > max_load * static_cast<float>(m_cells.size()))
+        {
+            rebuild();
+        }
+        else
+        {
+            m_cells[cell_of(p)].push_back(index);
+        }
+        return index;
+    }
+
+    std::size_t size() const
+    {
+        return m_points.size();
+    }
+
+    const point_type& operator[](std::size_t index) const
+    {
+        return m_points[index];
+    }
+
+    std::optional<std::size_t> nearest(const point_type& p) const
+    {
+        if (m_points.empty())
+        {
+            return std::nullopt;
+        }
+        const int cx = clamp_column(p[0]);
+        const int cy = clamp_row(p[1]);
+
+        std::optional<std::size_t> best = {};
+        float best_dist = std::numeric_limits<float>::max();
+        for (int r = 0;; ++r)
+        {
+            for_each_ring_cell(
+                cx,
+                cy,
+                r,
+                [&](std::size_t cell)
+                {
+                    for (const index_t i : m_cells[cell])
+                    {
+                        const float dist = distance_sqr(m_points[i], p);
+                        if (dist < best_dist)
+                        {
+                            best_dist = dist;
+                            best = i;
+                        }
+                    }
+                });
+
+            // Lower bound of the distance to any cell outside of the rings visited so far.
+            constexpr float inf = std::numeric_limits<float>::max();
+            const float left = cx - r - 1 >= 0 ? p[0] - column_start(cx - r) : inf;
+            const float right = cx + r + 1 < m_columns ? column_start(cx + r + 1) - p[0] : inf;
+            const float top = cy - r - 1 >= 0 ? p[1] - row_start(cy - r) : inf;
+            const float bottom = cy + r + 1 < m_rows ? row_start(cy + r + 1) - p[1] : inf;
+            const float bound = std::max(std::min({ left, right, top, bottom }), 0.F);
+            if (bound == inf || (best && best_dist <= bound * bound))
+            {
+                return best;
+            }
+        }
+    }
+
+    template <class Func>
+    void for_each_in_radius(const point_type& p, float radius, Func&& func) const
+    {
+        const float radius_sqr = radius * radius;
+        for_each_cell_in(
+            point_type{ p[0] - radius, p[1] - radius },
+            point_type{ p[0] + radius, p[1] + radius },
+            [&](index_t i)
+            {
+                if (distance_sqr(m_points[i], p) <= radius_sqr)
+                {
+                    func(static_cast<std::size_t>(i));
+                }
+            });
+    }
+
+    template <class Func>
+    void for_each_in_rect(const point_type& min, const point_type& max, Func&& func) const
+    {
+        for_each_cell_in(
+            min,
+            max,
+            [&](index_t i)
+            {
+                const point_type& q = m_points[i];
+                if (min[0] <= q[0] && q[0] <= max[0] && min[1] <= q[1] && q[1] <= max[1])
+                {
+                    func(static_cast<std::size_t>(i));
+                }
+            });
+    }
+
+private:
+    static float distance_sqr(const point_type& a, const point_type& b)
+    {
+        const float dx = a[0] - b[0];
+        const float dy = a[1] - b[1];
+        return dx * dx + dy * dy;
+    }
+
+    bool contains(const point_type& p) const
+    {
+        return !m_cells.empty() && m_min[0] <= p[0] && p[0] <= m_max[0] && m_min[1] <= p[1] && p[1] <= m_max[1];
+    }
+
+    float column_start(int x) const
+    {
+        return m_min[0] + static_cast<float>(x) * m_cell_size;
+    }
+
+    float row_start(int y) const
+    {
+        return m_min[1] + static_cast<float>(y) * m_cell_size;
+    }
+
+    int clamp_column(float x) const
+    {
+        return std::clamp(static_cast<int>(std::floor((x - m_min[0]) / m_cell_size)), 0, m_columns - 1);
+    }
+
+    int clamp_row(float y) const
+    {
+        return std::clamp(static_cast<int>(std::floor((y - m_min[1]) / m_cell_size)), 0, m_rows - 1);
+    }
+
+    std::size_t cell_of(const point_type& p) const
+    {
+        return static_cast<std::size_t>(clamp_row(p[1])) * m_columns + clamp_column(p[0]);
+    }
+
+    template <class Func>
+    void for_each_ring_cell(int cx, int cy, int r, Func&& func) const
+    {
+        for (int y = std::max(cy - r, 0); y <= std::min(cy + r, m_rows - 1); ++y)
+        {
+            const bool edge_row = y == cy - r || y == cy + r;
+            for (int x = std::max(cx - r, 0); x <= std::min(cx + r, m_columns - 1); ++x)
+            {
+                if (edge_row || x == cx - r || x == cx + r)
+                {
+                    func(static_cast<std::size_t>(y) * m_columns + x);
+                }
+            }
+        }
+    }
+
+    template <class Func>
+    void for_each_cell_in(const point_type& min, const point_type& max, Func&& func) const
+    {
+        if (m_cells.empty() || max[0] < m_min[0] || max[1] < m_min[1] || min[0] > m_max[0] || min[1] > m_max[1])
+        {
+            return;
+        }
+        for (int y = clamp_row(min[1]); y <= clamp_row(max[1]); ++y)
+        {
+            for (int x = clamp_column(min[0]); x <= clamp_column(max[0]); ++x)
+            {
+                for (const index_t i : m_cells[static_cast<std::size_t>(y) * m_columns + x])
+                {
+                    func(i);
+                }
+            }
+        }
+    }
+
+    // Covers the bounding box of all points, enlarged so that the grid does not need to grow on every new extreme,
+    // with roughly one point per cell.
+    void rebuild()
+    {
+        point_type min = m_points.front();
+        point_type max = m_points.front();
+        for (const point_type& p : m_points)
+        {
+            min = point_type{ std::min(min[0], p[0]), std::min(min[1], p[1]) };
+            max = point_type{ std::max(max[0], p[0]), std::max(max[1], p[1]) };
+        }
+        const float margin = std::max({ max[0] - min[0], max[1] - min[1], 1.F }) * 0.25F;
+        m_min = point_type{ min[0] - margin, min[1] - margin };
+        m_max = point_type{ max[0] + margin, max[1] + margin };
+
+        const float width = m_max[0] - m_min[0];
+        const float height = m_max[1] - m_min[1];
+        const float cells = std::max(static_cast<float>(m_points.size()), 1.F);
+        m_cell_size = std::sqrt(width * height / cells);
+        m_columns = std::max(static_cast<int>(std::ceil(width / m_cell_size)), 1);
+        m_rows = std::max(static_cast<int>(std::ceil(height / m_cell_size)), 1);
+
+        m_cells.assign(static_cast<std::size_t>(m_columns) * m_rows, {});
+        for (index_t i = 0; i < m_points.size(); ++i)
+        {
+            m_cells[cell_of(m_points[i])].push_back(i);
+        }
+    }
+
+    std::vector<point_type> m_points = {};
+    std::vector<std::vector<index_t>> m_cells = {};
+    point_type m_min = {};
+    point_type m_max = {};
+    float m_cell_size = 1.F;
+    int m_columns = 0;
+    int m_rows = 0;
+};
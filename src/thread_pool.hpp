@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// `parallel_for` splits a range into chunks whose boundaries depend only on the chunk size, and threads claim chunks
+// from a shared counter until none are left, so the work done for each index is the same for any number of threads.
+// The loops are flat and spawn no nested tasks, so per-thread deques with work stealing would balance them no better
+// than the counter does, at the cost of a deque per thread.
+// The calling thread takes part in every loop; a pool of size 1 runs everything inline.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t size = std::thread::hardware_concurrency())
+    {
+        for (std::size_t i = 1; i < std::max(size, std::size_t{ 1 }); ++i)
+        {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    // Number of threads taking part in a loop, including the calling one.
+    std::size_t size() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    // Calls `func(begin, end)` for the chunks [0, chunk_size), [chunk_size, 2 * chunk_size), ... of [0, count) and returns
+    // when all of them are done. The first exception thrown by `func` is rethrown. Not reentrant.
+    template <class Func>
+    void parallel_for(std::size_t count, std::size_t chunk_size, Func&& func)
+    {
+        chunk_size = std::max(chunk_size, std::size_t{ 1 });
+        if (m_threads.empty() || count <= chunk_size)
+        {
+            for (std::size_t begin = 0; begin < count; begin += chunk_size)
+            {
+                func(begin, std::min(begin + chunk_size, count));
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_job = job{ &invoke<std::remove_reference_t<Func>>, &func, count, chunk_size };
+            m_next_chunk = 0;
+            m_pending = m_threads.size();
+            m_error = nullptr;
+            ++m_epoch;
+        }
+        m_start.notify_all();
+        work(m_job);
+
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_done.wait(lock, [this] { return m_pending == 0; });
+        if (m_error)
+        {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+private:
+    struct job
+    {
+        void (*invoke)(void*, std::size_t, std::size_t) = nullptr;
+        void* func = nullptr;
+        std::size_t count = 0;
+        std::size_t chunk_size = 1;
+    };
+
+    template <class Func>
+    static void invoke(void* func, std::size_t begin, std::size_t end)
+    {
+        (*static_cast<Func*>(func))(begin, end);
+    }
+
+    void work(const job& j)
+    {
+        const std::size_t chunks = (j.count + j.chunk_size - 1) / j.chunk_size;
+        for (std::size_t chunk = m_next_chunk++; chunk < chunks; chunk = m_next_chunk++)
+        {
+            const std::size_t begin = chunk * j.chunk_size;
+            try
+            {
+                j.invoke(j.func, begin, std::min(begin + j.chunk_size, j.count));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                if (!m_error)
+                {
+                    m_error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void run()
+    {
+        std::uint64_t epoch = 0;
+        while (true)
+        {
+            job j;
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_start.wait(lock, [&] { return m_stop || m_epoch != epoch; });
+                if (m_stop)
+                {
+                    return;
+                }
+                epoch = m_epoch;
+                j = m_job;
+            }
+
+            work(j);
+
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (--m_pending == 0)
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    job m_job = {};
+    std::atomic<std::size_t> m_next_chunk{ 0 };
+    std::size_t m_pending = 0;  // workers that have not finished the current loop
+    std::uint64_t m_epoch = 0;
+    std::exception_ptr m_error = nullptr;
+    bool m_stop = false;
+
+    std::vector<std::thread> m_threads;  // last, so that it starts after all other members are initialized
+};
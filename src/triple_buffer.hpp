@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+// Hands the latest value from one producer thread to one consumer thread without locks or waiting.
+// Of three slots, the producer owns one, the consumer owns one, and the third holds the most recently published value;
+// publishing and acquiring swap the owned slot with the shared one. Filling the `back` slot in place assigns over a value
+// published earlier, so containers reuse their storage once every slot has been filled.
+template <class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side: the slot to fill before `publish`, default-constructed on first use.
+    T& back()
+    {
+        std::optional<T>& slot = m_slots[m_back];
+        if (!slot)
+        {
+            slot.emplace();
+        }
+        return *slot;
+    }
+
+    // Producer side: hands the `back` slot over to the consumer.
+    void publish()
+    {
+        m_back = m_shared.exchange(m_back | fresh, std::memory_order_acq_rel) & index_mask;
+    }
+
+    void publish(const T& value)
+    {
+        back() = value;
+        publish();
+    }
+
+    void publish(T&& value)
+    {
+        back() = std::move(value);
+        publish();
+    }
+
+    // Consumer side. Returns the most recently published value, or null if there is none yet. The value stays valid
+    // until the next call.
+    const T* acquire()
+    {
+        if (m_shared.load(std::memory_order_relaxed) & fresh)
+        {
+            m_front = m_shared.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+        }
+        return m_slots[m_front] ? &*m_slots[m_front] : nullptr;
+    }
+
+private:
+    static constexpr std::uint8_t index_mask = 0x3;
+    static constexpr std::uint8_t fresh = 0x4;  // set when the shared slot holds a value not yet acquired
+
+    std::array<std::optional<T>, 3> m_slots = {};
+    std::uint8_t m_back = 0;                  // owned by the producer
+    std::atomic<std::uint8_t> m_shared{ 1 };  // index of the shared slot, with the `fresh` flag
+    std::uint8_t m_front = 2;                 // owned by the consumer
+};
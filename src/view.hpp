@@ -4,55 +4,189 @@
 #include "canvas.hpp"
 #include "model.hpp"
 
+// What `Render` reads from a `Model`, copied from it after the ticks of a frame so that the model can move on while the
+// copy is drawn. Holds values and the immutable geometry only, none of the model's workers, pools or scratch buffers.
+struct ModelSnapshot
+{
+    using vec2 = zx::mat::vector_t<float, 2>;
+
+    std::shared_ptr<const DcelGeometry> geometry = std::make_shared<const DcelGeometry>();
+    std::vector<vec2> points = {};
+    std::optional<vec2> cursor = {};
+    std::optional<vec2> nearest_point = {};  // to the cursor
+    std::vector<vec2> moving_points = {};
+    // Boids are drawn blended from their locations as of the previous tick to those of the last one; boids that
+    // wrapped around the world in between start from the latter.
+    std::vector<vec2> boids_from = {};
+    std::vector<vec2> boids_to = {};
+
+    // Overwrites this snapshot, reusing its storage.
+    void assign(const Model& m)
+    {
+        const DcelModel& dcel = m.dcel_model;
+        geometry = dcel.geometry;
+        points.assign(dcel.points.begin(), dcel.points.end());
+        cursor = dcel.cursor;
+        nearest_point.reset();
+        if (const auto nearest = cursor ? dcel.index.nearest(*cursor) : std::nullopt)
+        {
+            nearest_point = dcel.index[*nearest];
+        }
+        const PointsModel& moving = m.points_model;
+        moving_points.assign(moving.positions.values().begin(), moving.positions.values().end());
+        moving_points.insert(moving_points.end(), moving.instance_positions.begin(), moving.instance_positions.end());
+        boids_to.assign(m.flock.locations().begin(), m.flock.locations().end());
+        boids_from.resize(m.flock.size());
+        for (std::size_t i = 0; i < boids_from.size(); ++i)
+        {
+            boids_from[i] = m.flock.location(i, 0.F);
+        }
+    }
+};
+
 struct Render
 {
+    // Layers of static geometry kept between frames in retained mode. Shared by copies of the renderer.
+    struct Cache
+    {
+        canvas::RetainedOp geometry;
+        canvas::RetainedOp points;
+        std::shared_ptr<canvas::PointBatch> moving_points = std::make_shared<canvas::PointBatch>();
+        std::shared_ptr<canvas::PointBatch> boids = std::make_shared<canvas::PointBatch>(4);
+    };
+
     sf::Color voronoi_outline_color = sf::Color::Red;
     sf::Color dcel_outline_color = sf::Color::White;
     sf::Color point_fill_color = sf::Color::Yellow;
+    sf::Color hover_color = sf::Color::Cyan;
+    sf::Color boid_color = sf::Color::Green;
+    bool retained = true;
+    bool batched = true;  // one draw call per layer instead of one shape per face or point
+    std::shared_ptr<Cache> cache = std::make_shared<Cache>();
 
-    canvas::DrawOp operator()(const DcelModel& m, fps_t fps) const
+    using Polygon = std::vector<zx::mat::vector_t<float, 2>>;
+
+    canvas::DrawOp outlines(const std::vector<Polygon>& polygons, float thickness, const sf::Color& color) const
     {
-        std::vector<canvas::DrawOp> items;
-        if (m.voronoi)
+        const canvas::StateModifier style = canvas::outline_thickness(thickness)  //
+                                            | canvas::fill_color(sf::Color::Transparent)
+                                            | canvas::outline_color(color);
+        if (batched)
         {
-            for (const auto& face : m.voronoi->faces())
+            return canvas::polygons(polygons) | style;
+        }
+        return canvas::transform([&](const Polygon& polygon) { return canvas::polygon(polygon) | style; }, polygons);
+    }
+
+    canvas::DrawOp geometry_layer(const DcelGeometry& geometry) const
+    {
+        const auto& cells = geometry.triangulation.cells();
+        std::vector<Polygon> voronoi_faces(cells.begin(), cells.end());
+        std::vector<Polygon> dcel_faces;
+        if (geometry.voronoi)
+        {
+            for (const auto& face : geometry.voronoi->faces())
             {
-                items.push_back(
-                    canvas::polygon(face.as_polygon())            //
-                    | canvas::outline_thickness(1.F)              //
-                    | canvas::fill_color(sf::Color::Transparent)  //
-                    | canvas::outline_color(voronoi_outline_color));
+                voronoi_faces.push_back(face.as_polygon());
             }
         }
-        if (m.dcel)
+        if (geometry.dcel)
         {
-            for (const auto& face : m.dcel->faces())
+            for (const auto& face : geometry.dcel->faces())
             {
-                items.push_back(
-                    canvas::polygon(face.as_polygon())            //
-                    | canvas::outline_thickness(1.5F)             //
-                    | canvas::fill_color(sf::Color::Transparent)  //
-                    | canvas::outline_color(dcel_outline_color));
+                dcel_faces.push_back(face.as_polygon());
             }
         }
-        items.push_back(canvas::transform(
+        for (const auto& triangle : geometry.triangulation.triangles())
+        {
+            dcel_faces.push_back(Polygon(triangle.begin(), triangle.end()));
+        }
+        return canvas::group(
+            outlines(voronoi_faces, 1.F, voronoi_outline_color),  //
+            outlines(dcel_faces, 1.5F, dcel_outline_color));
+    }
+
+    canvas::DrawOp points_layer(const ModelSnapshot& m) const
+    {
+        if (batched)
+        {
+            return canvas::points(m.points, 5.F) | canvas::fill_color(point_fill_color);
+        }
+        return canvas::transform(
             [this](const zx::mat::vector_t<float, 2>& p) -> canvas::DrawOp
             { return canvas::point(p, 5.F) | canvas::fill_color(point_fill_color); },
-            m.points));
+            m.points);
+    }
 
-        return canvas::group(std::move(items));
+    // Voronoi cell under the cursor and the point nearest to it.
+    canvas::DrawOp hover_layer(const ModelSnapshot& m) const
+    {
+        if (!m.cursor)
+        {
+            return canvas::empty_item();
+        }
+        canvas::DrawOp result;
+        const auto& triangulation = m.geometry->triangulation;
+        if (const auto site = triangulation.nearest_site(*m.cursor))
+        {
+            result.append(
+                canvas::polygon(triangulation.cells()[*site])  //
+                | canvas::outline_thickness(2.F)               //
+                | canvas::fill_color(sf::Color::Transparent)   //
+                | canvas::outline_color(hover_color));
+        }
+        if (m.nearest_point)
+        {
+            result.append(canvas::point(*m.nearest_point, 7.F) | canvas::fill_color(hover_color));
+        }
+        return result;
     }
 
-    canvas::DrawOp operator()(const PointsModel& m, fps_t fps) const
+    canvas::DrawOp dcel_layers(const ModelSnapshot& m) const
     {
+        if (!retained)
+        {
+            return canvas::group(geometry_layer(*m.geometry), points_layer(m), hover_layer(m));
+        }
+        // `points` is append-only, so its size is a sufficient version stamp.
+        return canvas::group(
+            canvas::ref(cache->geometry.get(m.geometry->generation, [&] { return geometry_layer(*m.geometry); })),
+            canvas::ref(cache->points.get(m.points.size(), [&] { return points_layer(m); })),
+            hover_layer(m));
+    }
+
+    canvas::DrawOp moving_points_layer(const ModelSnapshot& m) const
+    {
+        if (batched)
+        {
+            return canvas::points(cache->moving_points,
+                                  m.moving_points,
+                                  5.F,
+                                  [](const zx::mat::vector_t<float, 2>& p) { return p; })
+                   | canvas::fill_color(point_fill_color);
+        }
         return canvas::transform(
-            [this](const PointsModel::Point& point) -> canvas::DrawOp
-            { return canvas::point(point.pos, 5.F) | canvas::fill_color(point_fill_color); },
-            m.points);
+            [this](const zx::mat::vector_t<float, 2>& p) -> canvas::DrawOp
+            { return canvas::point(p, 5.F) | canvas::fill_color(point_fill_color); },
+            m.moving_points);
+    }
+
+    canvas::DrawOp boids_layer(const ModelSnapshot& m, float alpha) const
+    {
+        std::pmr::vector<zx::mat::vector_t<float, 2>> locations{ frame_resource() };
+        locations.reserve(m.boids_to.size());
+        for (std::size_t i = 0; i < m.boids_to.size(); ++i)
+        {
+            const zx::mat::vector_t<float, 2>& from = m.boids_from[i];
+            const zx::mat::vector_t<float, 2>& to = m.boids_to[i];
+            locations.push_back({ from[0] + alpha * (to[0] - from[0]), from[1] + alpha * (to[1] - from[1]) });
+        }
+        return canvas::points(cache->boids, locations, 2.F, [](const zx::mat::vector_t<float, 2>& p) { return p; })
+               | canvas::fill_color(boid_color);
     }
 
-    canvas::DrawOp operator()(const Model& m, fps_t fps) const
+    canvas::DrawOp operator()(const ModelSnapshot& m, fps_t /*fps*/, float alpha) const
     {
-        return canvas::group((*this)(m.dcel_model, fps), (*this)(m.points_model, fps));
+        return canvas::group(dcel_layers(m), moving_points_layer(m), boids_layer(m, alpha));
     }
 };